@@ -6,7 +6,7 @@
  * 32 bytes for cmd buffer, 16 for RX buffer,
  * 32 bytes for history,
  * 3 binding functions and no dynamic allocation
- * Total size of firmware is 7538 bytes, 654 bytes of RAM are used.
+ * Total size of firmware is 7538 bytes, 754 bytes of RAM are used.
  * Not everything is used by library, some memory is used by Serial, for
  * example.
  * Most of RAM space is taken up by char arrays so size can be reduced if
@@ -14,14 +14,14 @@
  * For example, by removing code inside onHelp and onUnknown functions inside
  * library (and replacing help strings in bindings by nullptr's) size of FW is
  * reduced by 688 bytes of ROM and 190 bytes of RAM. Total usage is then
- * 6850 of ROM and 464 of RAM.
+ * 6850 of ROM and 564 of RAM.
  */
 
 #define EMBEDDED_CLI_IMPL
 #include "embedded_cli.h"
 
-// 164 bytes is minimum size for this params on Arduino Nano
-#define CLI_BUFFER_SIZE 164
+// 296 bytes is minimum size for this params on Arduino Nano
+#define CLI_BUFFER_SIZE 264
 #define CLI_RX_BUFFER_SIZE 16
 #define CLI_CMD_BUFFER_SIZE 32
 #define CLI_HISTORY_SIZE 32
@@ -0,0 +1,150 @@
+#!/usr/bin/python3
+"""
+Compress help strings of bindings with static dictionary.
+
+Input file contains one help string per line in form "NAME help text",
+empty lines and lines starting with '#' are skipped. Output header contains
+macro for each string and dictionary that should be set as helpDictionary in
+cli config:
+
+    python3 build-help.py help.txt help_strings.h
+"""
+import sys
+
+# first char of compressed string (CLI_HELP_COMPRESSED in embedded_cli.h)
+MARKER = 0x01
+# chars from this code are references to dictionary entries
+FIRST_REF = 0x80
+MAX_ENTRIES = 0x100 - FIRST_REF
+MAX_ENTRY_LEN = 32
+# each entry also takes pointer in dictionary array
+POINTER_SIZE = 4
+
+HEADER_TEMPLATE = """\
+/**
+ * This header was automatically built using build-help.py from {source}
+ * Help strings: {plain} bytes, compressed: {compressed} bytes (with dictionary)
+ */
+#ifndef EMBEDDED_CLI_HELP_STRINGS_H
+#define EMBEDDED_CLI_HELP_STRINGS_H
+
+{macros}
+
+static const char *const cliHelpDictionary[] = {{
+{entries}
+}};
+
+#endif // EMBEDDED_CLI_HELP_STRINGS_H
+"""
+
+
+def read_strings(path):
+    strings = []
+    with open(path, 'r') as source:
+        for number, line in enumerate(source.read().splitlines(), 1):
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            name, _, text = line.partition(' ')
+            text = text.strip()
+            if not text or any(ord(c) < 0x20 or ord(c) >= 0x7F for c in text):
+                sys.exit("{}:{}: help text must be non-empty printable ASCII".format(path, number))
+            strings.append((name, text))
+    return strings
+
+
+def count_substrings(codes):
+    counts = {}
+    for string in codes:
+        for start in range(len(string)):
+            if string[start] >= FIRST_REF:
+                continue
+            for end in range(start + 2, min(start + MAX_ENTRY_LEN, len(string)) + 1):
+                if string[end - 1] >= FIRST_REF:
+                    break
+                key = tuple(string[start:end])
+                counts[key] = counts.get(key, 0) + 1
+    return counts
+
+
+def replace(string, entry, code):
+    result = []
+    i = 0
+    while i < len(string):
+        if tuple(string[i:i + len(entry)]) == entry:
+            result.append(code)
+            i += len(entry)
+        else:
+            result.append(string[i])
+            i += 1
+    return result
+
+
+def build_dictionary(codes):
+    dictionary = []
+    while len(dictionary) < MAX_ENTRIES:
+        best, best_saving = None, 0
+        for entry, count in count_substrings(codes).items():
+            # entry is stored once with null char and pointer
+            saving = count * (len(entry) - 1) - len(entry) - 1 - POINTER_SIZE
+            if saving > best_saving:
+                best, best_saving = entry, saving
+        if best is None:
+            break
+        code = FIRST_REF + len(dictionary)
+        codes = [replace(string, best, code) for string in codes]
+        dictionary.append(best)
+    return dictionary, codes
+
+
+def c_literal(codes):
+    result = ''
+    hex_before = False
+    for code in codes:
+        c = chr(code)
+        if code < 0x20 or code >= 0x7F:
+            result += '\\x{:02X}'.format(code)
+            hex_before = True
+            continue
+        # hex escape would consume following hex digit
+        if hex_before and c in '0123456789abcdefABCDEF':
+            result += '" "'
+        if c in '"\\':
+            result += '\\'
+        result += c
+        hex_before = False
+    return '"' + result + '"'
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("Usage: build-help.py <help.txt> <output.h>")
+
+    strings = read_strings(sys.argv[1])
+    dictionary, codes = build_dictionary([[ord(c) for c in text] for _, text in strings])
+
+    macros = []
+    plain_size = 0
+    compressed_size = sum(len(entry) + 1 + POINTER_SIZE for entry in dictionary)
+    for (name, text), string in zip(strings, codes):
+        plain = [ord(c) for c in text]
+        # string is left as is if compression doesn't help
+        if len(string) + 1 >= len(plain):
+            string = plain
+        else:
+            string = [MARKER] + string
+        plain_size += len(text) + 1
+        compressed_size += len(string) + 1
+        macros.append('#define {} {}'.format(name, c_literal(string)))
+
+    entries = ',\n'.join('        ' + c_literal(list(entry)) for entry in dictionary)
+    with open(sys.argv[2], 'w') as output:
+        output.write(HEADER_TEMPLATE.format(source=sys.argv[1],
+                                            plain=plain_size,
+                                            compressed=compressed_size,
+                                            macros='\n'.join(macros),
+                                            entries=entries if entries else '        ""'))
+
+
+if __name__ == '__main__':
+    main()
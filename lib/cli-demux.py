@@ -0,0 +1,142 @@
+#!/usr/bin/python3
+"""
+Host side of EmbeddedCliMux. Splits byte stream with COBS encoded frames
+(tag and payload, each frame ends with 0x00) into channels: console channel is printed to stdout, other channels are appended
+to files channel-N.log in output directory. Lines typed to stdin are sent to
+console channel if stream is writable device:
+
+    stty -F /dev/ttyUSB0 115200 raw -echo
+    python3 cli-demux.py /dev/ttyUSB0
+
+Recorded stream can be split without device:
+
+    python3 cli-demux.py capture.bin --out-dir logs
+"""
+import argparse
+import os
+import sys
+import threading
+
+# must match CLI_MUX_TAG and CLI_MUX_MAX_CHANNELS in embedded_cli.h
+MUX_TAG = 0xC0
+MAX_CHANNELS = 16
+
+
+class Demux:
+    def __init__(self):
+        # everything before first delimiter is skipped (for example, output
+        # printed before mux was started)
+        self.state = 'sync'
+        self.channel = 0
+        self.code = 0
+        self.left = 0
+
+    def feed(self, data):
+        """Return list of (channel, payload) for all bytes of data"""
+        parts = []
+        for b in data:
+            if b == 0:
+                self.state = 'tag'
+                self.code = 0
+                self.left = 0
+            elif self.state == 'sync':
+                continue
+            elif self.left > 0:
+                self.left -= 1
+                self._decoded(b, parts)
+            else:
+                # each block except the last and full ones ends with zero
+                add_zero = self.code not in (0, 0xFF)
+                self.code = b
+                self.left = b - 1
+                if add_zero:
+                    self._decoded(0, parts)
+        return parts
+
+    def _decoded(self, b, parts):
+        if self.state == 'tag':
+            # frame with damaged tag is skipped until next delimiter
+            if b & 0xF0 == MUX_TAG:
+                self.channel = b & 0x0F
+                self.state = 'payload'
+            else:
+                self.state = 'sync'
+        elif parts and parts[-1][0] == self.channel:
+            parts[-1][1].append(b)
+        else:
+            parts.append((self.channel, bytearray([b])))
+
+
+def cobs_encode(data):
+    result = bytearray()
+    block = bytearray()
+    for b in data:
+        if b == 0:
+            result += bytes([len(block) + 1]) + block
+            block = bytearray()
+            continue
+        block.append(b)
+        if len(block) == 254:
+            result += b'\xff' + block
+            block = bytearray()
+    result += bytes([len(block) + 1]) + block
+    return bytes(result)
+
+
+def frames(channel, data):
+    """Split data into frames of given channel"""
+    result = bytearray()
+    for i in range(0, len(data), 255):
+        result += cobs_encode(bytes([MUX_TAG | channel]) + data[i:i + 255]) + b'\x00'
+    return bytes(result)
+
+
+def send_input(fd, channel):
+    # device discards everything before first delimiter
+    os.write(fd, b'\x00')
+    for line in sys.stdin:
+        os.write(fd, frames(channel, line.rstrip('\n').encode() + b'\r\n'))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Demultiplex channels of embedded-cli mux stream')
+    parser.add_argument('stream', help='serial device or file with recorded stream')
+    parser.add_argument('--console', type=int, default=0, help='channel printed to stdout (default 0)')
+    parser.add_argument('--out-dir', default='.', help='directory for files of other channels')
+    args = parser.parse_args()
+
+    if not 0 <= args.console < MAX_CHANNELS:
+        sys.exit("Console channel must be less than {}".format(MAX_CHANNELS))
+
+    is_device = not os.path.isfile(args.stream)
+    fd = os.open(args.stream, os.O_RDWR if is_device else os.O_RDONLY)
+    if is_device:
+        threading.Thread(target=send_input, args=(fd, args.console), daemon=True).start()
+
+    demux = Demux()
+    files = {}
+    try:
+        while True:
+            data = os.read(fd, 4096)
+            if not data:
+                break
+            for channel, payload in demux.feed(data):
+                if channel == args.console:
+                    sys.stdout.buffer.write(payload)
+                    sys.stdout.flush()
+                    continue
+                if channel not in files:
+                    path = os.path.join(args.out_dir, 'channel-{}.log'.format(channel))
+                    files[channel] = open(path, 'ab')
+                files[channel].write(payload)
+                files[channel].flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        for f in files.values():
+            f.close()
+        os.close(fd)
+
+
+if __name__ == '__main__':
+    main()
@@ -13,6 +13,7 @@ extern "C" {
 
 // cstdint is available only since C++11, so use C header
 #include <stdint.h>
+#include <stddef.h>
 
 // used for proper alignment of cli buffer
 #if UINTPTR_MAX == 0xFFFF
@@ -31,10 +32,91 @@ extern "C" {
 #define BYTES_TO_CLI_UINTS(bytes) \
   (((bytes) + CLI_UINT_SIZE - 1)/CLI_UINT_SIZE)
 
+/**
+ * Number of buckets in latency histogram of binding stats
+ */
+#define CLI_LATENCY_BUCKETS 16
+
+/**
+ * Flags for embeddedCliExecute
+ * CLI_EXECUTE_HISTORY - put executed command to history
+ * CLI_EXECUTE_OUTPUT - print output of command to cli output (otherwise
+ * it is discarded)
+ */
+#define CLI_EXECUTE_HISTORY 0x01u
+#define CLI_EXECUTE_OUTPUT 0x02u
+
+/**
+ * Flag for embeddedCliRunScript (can be combined with CLI_EXECUTE_* flags)
+ * CLI_SCRIPT_STOP_ON_ERROR - stop script after first failed line
+ */
+#define CLI_SCRIPT_STOP_ON_ERROR 0x04u
+
+/**
+ * Status of framed request (last byte of response before CRC)
+ * CLI_FRAME_STATUS_OK - binding was called and succeeded
+ * CLI_FRAME_STATUS_FAILED - binding was called and reported failure
+ * CLI_FRAME_STATUS_UNKNOWN - there is no binding with given id or binding
+ * can't be called in framed mode (watch)
+ * CLI_FRAME_STATUS_INVALID - frame is too long, too short or CRC is wrong
+ * (binding id in response is CLI_BINDING_ID_NONE)
+ * CLI_FRAME_STATUS_MESSAGE - not a response, but string printed with
+ * embeddedCliPrint outside of bindings (binding id is CLI_BINDING_ID_NONE)
+ */
+#define CLI_FRAME_STATUS_OK 0u
+#define CLI_FRAME_STATUS_FAILED 1u
+#define CLI_FRAME_STATUS_UNKNOWN 2u
+#define CLI_FRAME_STATUS_INVALID 3u
+#define CLI_FRAME_STATUS_MESSAGE 4u
+
+/**
+ * Frames of EmbeddedCliMux: tag (CLI_MUX_TAG | channel) and payload (up to
+ * maxPayloadSize bytes), COBS encoded and ended with 0x00. Zero never appears
+ * inside of frame, so after lost or corrupted byte stream is synchronized
+ * again at the next delimiter (only the damaged frame is affected). Both
+ * sides discard everything before the first 0x00, so mux writes it before
+ * its first frame and host should do the same.
+ */
+#define CLI_MUX_TAG 0xC0u
+#define CLI_MUX_MAX_CHANNELS 16u
+
+/**
+ * Returned by embeddedCliGetBindingId for unknown binding
+ */
+#define CLI_BINDING_ID_NONE 0xFFFFu
+
+/**
+ * First char of help string that is compressed with build-help.py. In such
+ * string chars from 0x80 are replaced by entries of helpDictionary from
+ * config (char 0x80 + i is replaced by entry i)
+ */
+#define CLI_HELP_COMPRESSED '\x01'
+
+/**
+ * Received chars that trigger onInputReady callback (see inputReadyTriggers
+ * in config)
+ * CLI_INPUT_READY_LINE_END - \r or \n (command is ready to be executed), in
+ * framed mode 0x00 (end of request)
+ * CLI_INPUT_READY_ESCAPE - last char of escape sequence (arrow keys)
+ * CLI_INPUT_READY_TAB - tab (manual autocompletion)
+ * CLI_INPUT_READY_OTHER - all other chars (they are only echoed or edit
+ * current command), in framed mode all bytes of request except delimiter
+ */
+#define CLI_INPUT_READY_LINE_END 0x01u
+#define CLI_INPUT_READY_ESCAPE 0x02u
+#define CLI_INPUT_READY_TAB 0x04u
+#define CLI_INPUT_READY_OTHER 0x08u
+#define CLI_INPUT_READY_ALL 0x0Fu
+
+typedef struct CliBindingStats CliBindingStats;
 typedef struct CliCommand CliCommand;
 typedef struct CliCommandBinding CliCommandBinding;
 typedef struct EmbeddedCli EmbeddedCli;
 typedef struct EmbeddedCliConfig EmbeddedCliConfig;
+typedef struct CliScriptOptions CliScriptOptions;
+typedef struct CliScriptResult CliScriptResult;
+typedef struct EmbeddedCliMux EmbeddedCliMux;
+typedef struct EmbeddedCliMuxConfig EmbeddedCliMuxConfig;
 
 
 struct CliCommand {
@@ -83,13 +165,37 @@ struct CliCommandBinding {
     /**
      * Binding function for when command is received.
      * If null, default callback (onCommand) will be called.
-     * @param cli - pointer to cli that is calling this binding
+     * @param cli - pointer to cli that is calling this binding. It is a copy
+     * of cli (with the same appContext) that is valid only until binding returns
      * @param args - string of args (if tokenizeArgs is false) or tokens otherwise
      * @param context
      */
     void (*binding)(EmbeddedCli *cli, char *args, void *context);
 };
 
+/**
+ * Call statistics of single binding (collected only if enabled in config)
+ */
+struct CliBindingStats {
+    /**
+     * Number of times binding was called
+     */
+    uint32_t calls;
+
+    /**
+     * Number of calls that were marked as failed with embeddedCliCommandFailed
+     */
+    uint32_t errors;
+
+    /**
+     * Histogram of call durations, measured with getTime callback.
+     * Bucket with index i counts calls with duration in [2^(i-1), 2^i),
+     * bucket 0 counts calls with zero duration and the last bucket also counts
+     * all longer calls. Counters stop at UINT16_MAX.
+     */
+    uint16_t latency[CLI_LATENCY_BUCKETS];
+};
+
 struct EmbeddedCli {
     /**
      * Should write char to connection
@@ -106,6 +212,28 @@ struct EmbeddedCli {
      */
     void (*onCommand)(EmbeddedCli *cli, CliCommand *command);
 
+    /**
+     * Optional. Should return current time in any units (for example, in
+     * microseconds). It is used to measure duration of binding calls when
+     * binding stats are enabled and to schedule watched commands (see
+     * ticksPerMs in config). Timer overflow is allowed.
+     * @param cli - pointer to cli that executed this function
+     */
+    uint32_t (*getTime)(EmbeddedCli *cli);
+
+    /**
+     * Optional. Called from embeddedCliReceiveChar when received char needs
+     * processing (see inputReadyTriggers in config) or when rx buffer
+     * overflows. Firmware can sleep until this notification instead of
+     * calling embeddedCliProcess in a loop. Called from the same context as
+     * embeddedCliReceiveChar (for example, from interrupt), so it should only
+     * set a flag or wake main loop. Also called by task that executed command
+     * with embeddedCliExecute, embeddedCliRunScript or embeddedCliReceiveLine
+     * if embeddedCliProcess left input meanwhile (see lock in config).
+     * @param cli - pointer to cli that received char
+     */
+    void (*onInputReady)(EmbeddedCli *cli);
+
     /**
      * Can be used for any application context
      */
@@ -149,9 +277,69 @@ struct EmbeddedCliConfig {
      * Maximum amount of bindings that can be added via addBinding function.
      * Cli increases takes extra bindings for internal commands:
      * - help
+     * - stats (only if enableBindingStats is true)
+     * - watch (only if maxWatchCount is not 0)
      */
     uint16_t maxBindingCount;
 
+    /**
+     * Maximum amount of commands that can be periodically executed at the
+     * same time via internal command "watch <ms> <command> [args...]".
+     * Each watch stores its arguments, so it requires cmdBufferSize extra
+     * bytes. If 0, command "watch" is not available.
+     */
+    uint16_t maxWatchCount;
+
+    /**
+     * Number of getTime units in one millisecond. Used to convert period of
+     * watched commands. Should not be 0.
+     */
+    uint16_t ticksPerMs;
+
+    /**
+     * Size of buffer for single line of filtered output. If not 0, output of
+     * command can be filtered with pipes:
+     * "cmd | grep pattern" - print only lines that contain pattern
+     * "cmd | head N" - print only first N lines
+     * "cmd | count" - print only number of lines
+     * Lines longer than buffer are truncated. If 0, pipes are not processed
+     * and passed to command as is.
+     */
+    uint16_t filterBufferSize;
+
+    /**
+     * Maximum amount of chars that internal commands "help" and "stats"
+     * (without arguments) write during single call to embeddedCliProcess.
+     * Rest of output is written by next calls, so long list of bindings
+     * doesn't block main loop. Any received key cancels output. Applied only
+     * to commands typed by user (not chained, filtered or executed via
+     * embeddedCliExecute). If 0, output is written at once.
+     */
+    uint16_t outputChunkSize;
+
+    /**
+     * Combination of CLI_INPUT_READY_* flags. Chars of these types trigger
+     * onInputReady callback. Without CLI_INPUT_READY_OTHER typed chars are
+     * echoed only after next trigger (for example, after return is pressed),
+     * but device wakes up less often.
+     */
+    uint8_t inputReadyTriggers;
+
+    /**
+     * Maximum size of decoded request in framed mode (binding id, args and
+     * CRC). Framed mode requires this amount plus 254 bytes for encoding of
+     * response. If 0, framed mode is not available.
+     */
+    uint16_t frameBufferSize;
+
+    /**
+     * Dictionary for help strings compressed by build-help.py (generated
+     * together with strings). Compressed strings are expanded directly into
+     * output, so no extra RAM is used. If NULL, help strings are printed
+     * as is.
+     */
+    const char *const *helpDictionary;
+
     /**
      * Buffer to use for cli and all internal structures. If NULL, memory will
      * be allocated dynamically. Otherwise this buffer is used and no
@@ -170,13 +358,188 @@ struct EmbeddedCliConfig {
      * complete current command manually.
      */
     bool enableAutoComplete;
+
+    /**
+     * Whether call statistics should be collected for each binding.
+     * If true, extra space is used for each binding and internal command
+     * "stats" is added.
+     */
+    bool enableBindingStats;
+
+    /**
+     * Whether multiple commands can be entered on single line.
+     * Commands are separated by ";" (execute next command unconditionally),
+     * "&&" (execute next command only if previous succeeded) or "||"
+     * (execute next command only if previous failed). Separators inside
+     * quotes or escaped with backslash are not treated as separators.
+     */
+    bool enableChaining;
+
+    /**
+     * Whether commands can be executed with embeddedCliExecute and
+     * embeddedCliRunScript. Requires cmdBufferSize extra bytes (the same
+     * buffer is used by watched commands, so it is not added again when
+     * maxWatchCount is not 0). If false, these functions return false
+     * (empty result) without executing anything.
+     */
+    bool enableExecute;
+
+    /**
+     * Optional. Called before internal state of cli is accessed from any
+     * function (except embeddedCliReceiveChar), so cli can be used from
+     * multiple threads. Bindings and onCommand are called while cli is
+     * unlocked, so they can use any cli function. Only one command is
+     * executed at a time: while it runs, embeddedCliExecute,
+     * embeddedCliRunScript and embeddedCliReceiveLine return false and
+     * embeddedCliProcess leaves input and returns false (onInputReady is
+     * called when command finishes). Output of command
+     * is redirected only for cli passed to its bindings, so messages printed
+     * meanwhile by other tasks are not filtered or discarded with it. Lock
+     * doesn't have to be recursive. Both lock and unlock must be set.
+     * @param cli - pointer to cli that is locked
+     */
+    void (*lock)(EmbeddedCli *cli);
+
+    /**
+     * Optional. Called to release lock taken with lock callback
+     * @param cli - pointer to cli that is unlocked
+     */
+    void (*unlock)(EmbeddedCli *cli);
+};
+
+/**
+ * Options for script execution
+ */
+struct CliScriptOptions {
+    /**
+     * Combination of CLI_EXECUTE_* and CLI_SCRIPT_* flags
+     */
+    uint8_t flags;
+
+    /**
+     * Optional. Called after each executed line of script (empty lines and
+     * comments are not executed).
+     * @param cli
+     * @param line - number of line in script (counted from 1)
+     * @param success - whether command at this line succeeded
+     * @param context - context from options
+     */
+    void (*onLineExecuted)(EmbeddedCli *cli, uint16_t line, bool success, void *context);
+
+    /**
+     * Any context that is provided to onLineExecuted
+     */
+    void *context;
+};
+
+/**
+ * Result of script execution
+ */
+struct CliScriptResult {
+    /**
+     * Number of executed lines (empty lines and comments are not counted)
+     */
+    uint16_t linesExecuted;
+
+    /**
+     * Number of lines that failed
+     */
+    uint16_t linesFailed;
+
+    /**
+     * Number of first failed line (counted from 1) or 0 if all lines succeeded
+     */
+    uint16_t firstFailedLine;
+
+    /**
+     * Total execution time measured with getTime (0 if getTime is not set)
+     */
+    uint32_t time;
+};
+
+/**
+ * Multiplexer of several logical channels over single byte stream. Each
+ * channel can have its own cli attached (for example, console and machine
+ * channel in framed mode), other channels are used for raw output like logs.
+ * Output of each channel is collected in its own buffer and written in
+ * tagged frames, channels take turns, so single channel can't block others.
+ */
+struct EmbeddedCliMux {
+    /**
+     * Should write bytes to connection. Each frame is written with several
+     * calls (COBS codes, tag, parts of payload and delimiter)
+     * @param mux - pointer to mux that executed this function
+     * @param data - bytes to write
+     * @param size - amount of bytes
+     */
+    void (*write)(EmbeddedCliMux *mux, const char *data, uint16_t size);
+
+    /**
+     * Optional. Called from embeddedCliMuxReceiveChar for each received byte
+     * of channel without attached cli
+     * @param mux - pointer to mux that received byte
+     * @param channel - channel of byte
+     * @param c - received byte
+     */
+    void (*onInput)(EmbeddedCliMux *mux, uint8_t channel, char c);
+
+    /**
+     * Can be used for any application context
+     */
+    void *appContext;
+
+    /**
+     * Pointer to actual implementation, do not use.
+     */
+    void *_impl;
+};
+
+/**
+ * Configuration to create EmbeddedCliMux
+ */
+struct EmbeddedCliMuxConfig {
+    /**
+     * Size of output buffer of each channel. When buffer is full, frame is
+     * written immediately
+     */
+    uint16_t txBufferSize;
+
+    /**
+     * Number of channels (up to CLI_MUX_MAX_CHANNELS)
+     */
+    uint8_t channelCount;
+
+    /**
+     * Maximum payload of single frame. Smaller frames make channels switch
+     * more often. Should not be 0.
+     */
+    uint8_t maxPayloadSize;
+
+    /**
+     * Buffer to use for mux. If NULL, memory will be allocated dynamically
+     */
+    CLI_UINT *muxBuffer;
+
+    /**
+     * Size of buffer for mux (in bytes)
+     */
+    uint16_t muxBufferSize;
 };
 
 /**
  * Returns pointer to default configuration for cli creation. It is safe to
  * modify it and then send to embeddedCliNew().
  * Returned structure is always the same so do not free and try to use it
- * immediately.
+ * immediately. It is shared by all callers, so use
+ * embeddedCliInitDefaultConfig if configs are created from multiple threads.
+ * Default values are listed in embeddedCliInitDefaultConfig.
+ * @return configuration for cli creation
+ */
+EmbeddedCliConfig *embeddedCliDefaultConfig(void);
+
+/**
+ * Fill given config with default values. Can be called from multiple
+ * threads at the same time (for different configs).
  * Default values:
  * <ul>
  * <li>rxBufferSize = 64</li>
@@ -185,11 +548,23 @@ struct EmbeddedCliConfig {
  * <li>cliBuffer = NULL (use dynamic allocation)</li>
  * <li>cliBufferSize = 0</li>
  * <li>maxBindingCount = 8</li>
+ * <li>maxWatchCount = 0</li>
+ * <li>ticksPerMs = 1</li>
+ * <li>filterBufferSize = 0</li>
+ * <li>outputChunkSize = 0</li>
+ * <li>frameBufferSize = 0</li>
+ * <li>helpDictionary = NULL</li>
+ * <li>inputReadyTriggers = CLI_INPUT_READY_ALL</li>
+ * <li>lock = NULL</li>
+ * <li>unlock = NULL</li>
  * <li>enableAutoComplete = true</li>
+ * <li>enableBindingStats = false</li>
+ * <li>enableChaining = false</li>
+ * <li>enableExecute = false</li>
  * </ul>
- * @return configuration for cli creation
+ * @param config - config to fill
  */
-EmbeddedCliConfig *embeddedCliDefaultConfig(void);
+void embeddedCliInitDefaultConfig(EmbeddedCliConfig *config);
 
 /**
  * Returns how many space in config buffer is required for cli creation
@@ -197,18 +572,21 @@ EmbeddedCliConfig *embeddedCliDefaultConfig(void);
  * This amount will always be divisible by CLI_UINT_SIZE so allocated buffer
  * and internal structures can be properly aligned
  * @param config
- * @return
+ * @return required size or 0 if config requires more than UINT16_MAX bytes
+ * (embeddedCliNew fails for such config)
  */
-uint16_t embeddedCliRequiredSize(EmbeddedCliConfig *config);
+uint16_t embeddedCliRequiredSize(const EmbeddedCliConfig *config);
 
 /**
  * Create new CLI.
  * Memory is allocated dynamically if cliBuffer in config is NULL.
+ * Config is not modified, so the same config can be used to create multiple
+ * instances (each with dynamic allocation or with its own cliBuffer).
  * After CLI is created, override function pointers to start using it
  * @param config - config for cli creation
  * @return pointer to created CLI
  */
-EmbeddedCli *embeddedCliNew(EmbeddedCliConfig *config);
+EmbeddedCli *embeddedCliNew(const EmbeddedCliConfig *config);
 
 /**
  * Same as calling embeddedCliNew with default config.
@@ -228,30 +606,226 @@ EmbeddedCli *embeddedCliNewDefault(void);
 void embeddedCliReceiveChar(EmbeddedCli *cli, char c);
 
 /**
- * Process rx/tx buffers. Command callbacks are called from here
+ * Process rx/tx buffers. Command callbacks are called from here.
+ * Watched commands are also executed from here when their period elapses,
+ * so this function should be called often enough even without input.
+ * If false is returned, there is nothing to do until next char is received
+ * (or until next watch time, see embeddedCliGetNextWatchTime), so firmware
+ * can sleep until onInputReady is called.
+ * @param cli
+ * @return true if there is pending work (unprocessed chars, late watches
+ * or unfinished output), so function should be called again
+ */
+bool embeddedCliProcess(EmbeddedCli *cli);
+
+/**
+ * Get time when the earliest watched command should be executed, so
+ * firmware can set timer before sleeping. Time might be already in the past
+ * if watch is late.
  * @param cli
+ * @param time - where time is stored (in units of getTime)
+ * @return false if there are no active watches
  */
-void embeddedCliProcess(EmbeddedCli *cli);
+bool embeddedCliGetNextWatchTime(EmbeddedCli *cli, uint32_t *time);
 
 /**
- * Add specified binding to list of bindings. If list is already full, binding
- * is not added and false is returned
+ * Add specified binding to list of bindings. If list is already full or
+ * binding with the same name already exists, binding is not added and false
+ * is returned
  * @param cli
  * @param binding
  * @return true if binding was added, false otherwise
  */
 bool embeddedCliAddBinding(EmbeddedCli *cli, CliCommandBinding binding);
 
+/**
+ * Remove binding with specified name. Slot of removed binding is reused by
+ * the next added binding, other bindings are not moved.
+ * @param cli
+ * @param name - name of binding to remove
+ * @return true if binding was removed, false if there is no such binding
+ */
+bool embeddedCliRemoveBinding(EmbeddedCli *cli, const char *name);
+
+/**
+ * Replace binding that has the same name as provided binding. Help, context
+ * and binding function are replaced without changing position of binding.
+ * @param cli
+ * @param binding
+ * @return true if binding was replaced, false if there is no such binding
+ */
+bool embeddedCliReplaceBinding(EmbeddedCli *cli, CliCommandBinding binding);
+
+/**
+ * Execute given command line directly, as if it was entered by user, without
+ * passing it through rx buffer. Line is copied to internal buffer, so
+ * currently entered command is not affected. Command is not echoed and not
+ * autocompleted.
+ * Line must fit into cmd buffer (same as typed commands). Can't be called
+ * while other command is executed (for example, from binding).
+ * Requires enableExecute in config.
+ * @param cli
+ * @param line - command with arguments (without line ending)
+ * @param flags - combination of CLI_EXECUTE_* flags
+ * @return true if command was executed and didn't report failure
+ */
+bool embeddedCliExecute(EmbeddedCli *cli, const char *line, uint8_t flags);
+
+/**
+ * Receive whole command line from transport that delivers input in lines or
+ * packets (USB CDC, sockets). Line is copied to cmd buffer at once and
+ * executed the same way as typed command (it is put to history and output
+ * is printed), but without per-char processing: there is no editing,
+ * autocompletion or live redraw. Currently entered command is replaced.
+ * Trailing \r and \n are ignored. Should be called from the same place as
+ * embeddedCliProcess, not from ISR.
+ * @param cli
+ * @param line - command with arguments
+ * @param len - length of line
+ * @param echo - write line back to output (when client doesn't echo locally)
+ * @return true if command was executed and didn't report failure
+ */
+bool embeddedCliReceiveLine(EmbeddedCli *cli, const char *line, size_t len, bool echo);
+
+/**
+ * Execute script with one command per line. Lines are separated by \r, \n
+ * or \r\n. Lines that begin with '#' are comments and are skipped, as are
+ * empty lines. Script is read directly from provided buffer (so it can be
+ * located in flash), lines are copied only when command needs mutable
+ * arguments. Script stops at len or at null char, whichever comes first.
+ * Can't be called while other command is executed (for example, from
+ * binding). Requires enableExecute in config.
+ * @param cli
+ * @param script
+ * @param len - length of script
+ * @param options - execution options (can be NULL to use default ones)
+ * @return result of execution
+ */
+CliScriptResult embeddedCliRunScript(EmbeddedCli *cli, const char *script, size_t len,
+                                     const CliScriptOptions *options);
+
+/**
+ * Mark currently executed command as failed. Should be called only from
+ * binding function. Failed calls are counted in binding stats and are
+ * reported by embeddedCliExecute.
+ * @param cli
+ */
+void embeddedCliCommandFailed(EmbeddedCli *cli);
+
+/**
+ * Get call statistics of binding with specified name. Statistics are copied,
+ * since they are updated by each call of binding
+ * @param cli
+ * @param name
+ * @param stats - where statistics are copied to
+ * @return false if stats are disabled or there is no such binding
+ */
+bool embeddedCliGetBindingStats(EmbeddedCli *cli, const char *name, CliBindingStats *stats);
+
+/**
+ * Reset call statistics of all bindings
+ * @param cli
+ */
+void embeddedCliResetBindingStats(EmbeddedCli *cli);
+
 /**
  * Print specified string and account for currently entered but not submitted
  * command.
  * Current command is deleted, provided string is printed (with new line) after
  * that current command is printed again, so user can continue typing it.
+ * In framed mode string is sent in separate frame (see
+ * CLI_FRAME_STATUS_MESSAGE) or dropped if response is written at that time.
  * @param cli
  * @param string
  */
 void embeddedCliPrint(EmbeddedCli *cli, const char *string);
 
+/**
+ * Switch input between text console and framed binary protocol. Can be
+ * called from binding, then mode is changed after current command.
+ * In framed mode each request is COBS encoded and ends with 0x00. Decoded
+ * request contains binding id (u16), args and CRC-16/CCITT-FALSE (u16) of
+ * previous bytes. Numbers are little endian. Args are passed to binding
+ * without tokenization: tokenized bindings expect them separated by null
+ * chars. Response is framed the same way and contains binding id, output
+ * of binding, status (one of CLI_FRAME_STATUS_*) and CRC, it also starts
+ * with 0x00. Host should send 0x00 first, since everything before it is
+ * discarded after switch.
+ * When text mode is restored, invitation is printed again.
+ * @param cli
+ * @param enabled - true to switch to framed mode
+ * @return false if framed mode is not available (frameBufferSize is 0)
+ */
+bool embeddedCliSetFramedMode(EmbeddedCli *cli, bool enabled);
+
+/**
+ * Return id of binding that is used in framed requests. Id doesn't change
+ * while binding exists
+ * @param cli
+ * @param name - name of binding
+ * @return id or CLI_BINDING_ID_NONE if there is no such binding
+ */
+uint16_t embeddedCliGetBindingId(EmbeddedCli *cli, const char *name);
+
+/**
+ * Return size of buffer that is required to save current state of cli
+ * @param cli
+ * @return size in bytes
+ */
+size_t embeddedCliGetStateSize(EmbeddedCli *cli);
+
+/**
+ * Save live state of cli (current command, history and whether invitation
+ * is already printed) to compact position independent buffer, so it can be
+ * kept in retention RAM while device sleeps. Bindings, watches and
+ * unprocessed received chars are not saved, so call it after
+ * embeddedCliProcess.
+ * @param cli
+ * @param buffer - buffer to save state to
+ * @param size - size of buffer
+ * @return number of bytes written or 0 if buffer is too small
+ */
+size_t embeddedCliSaveState(EmbeddedCli *cli, void *buffer, size_t size);
+
+/**
+ * Restore state saved with embeddedCliSaveState. Cli can be created with
+ * different config and buffer: if its history buffer is smaller, only the
+ * most recent items are restored. Bindings should be added as usual.
+ * @param cli
+ * @param buffer - saved state
+ * @param size - size of saved state
+ * @return false if state is corrupted or current command doesn't fit into
+ * cmd buffer (cli is not changed in this case)
+ */
+bool embeddedCliRestoreState(EmbeddedCli *cli, const void *buffer, size_t size);
+
+/**
+ * Start telnet session: negotiate character mode (server echoes input and
+ * go-ahead is suppressed) and ask client for window size. Output of cli is
+ * escaped for telnet from now on. Should be called when client connects,
+ * after writeChar is set.
+ * @param cli
+ */
+void embeddedCliTelnetStart(EmbeddedCli *cli);
+
+/**
+ * Receive bytes from telnet client. Telnet commands are removed and answered
+ * from next call to embeddedCliProcess, other bytes are passed to
+ * embeddedCliReceiveChar. Can be called from the same places as
+ * embeddedCliReceiveChar.
+ * @param cli
+ * @param data - received bytes
+ * @param size - amount of bytes
+ */
+void embeddedCliTelnetReceive(EmbeddedCli *cli, const char *data, size_t size);
+
+/**
+ * Return width of client window reported by telnet client
+ * @param cli
+ * @return width in chars or 0 if it is unknown
+ */
+uint16_t embeddedCliGetWindowWidth(EmbeddedCli *cli);
+
 /**
  * Free allocated for cli memory
  * @param cli
@@ -304,6 +878,78 @@ uint16_t embeddedCliFindToken(const char *tokenizedStr, const char *token);
  */
 uint16_t embeddedCliGetTokenCount(const char *tokenizedStr);
 
+/**
+ * Fill given mux config with default values.
+ * Default values:
+ * <ul>
+ * <li>txBufferSize = 128</li>
+ * <li>channelCount = 2</li>
+ * <li>maxPayloadSize = 64</li>
+ * <li>muxBuffer = NULL (use dynamic allocation)</li>
+ * <li>muxBufferSize = 0</li>
+ * </ul>
+ * @param config
+ */
+void embeddedCliMuxInitDefaultConfig(EmbeddedCliMuxConfig *config);
+
+/**
+ * Returns required size of buffer for mux with given config
+ * @param config
+ * @return required size in bytes
+ */
+uint16_t embeddedCliMuxRequiredSize(const EmbeddedCliMuxConfig *config);
+
+/**
+ * Create new mux. Write callback must be set before first call to
+ * embeddedCliMuxProcess
+ * @param config
+ * @return created mux or NULL if buffer is too small or channelCount is wrong
+ */
+EmbeddedCliMux *embeddedCliMuxNew(const EmbeddedCliMuxConfig *config);
+
+/**
+ * Attach cli to channel. Received bytes of channel are passed to this cli
+ * and its writeChar is replaced, so all its output goes to channel.
+ * @param mux
+ * @param channel
+ * @param cli
+ * @return false if channel doesn't exist
+ */
+bool embeddedCliMuxAttach(EmbeddedCliMux *mux, uint8_t channel, EmbeddedCli *cli);
+
+/**
+ * Receive byte from connection. Frames are decoded on the fly and their
+ * payload is passed to attached cli (with embeddedCliReceiveChar) or to
+ * onInput. Can be called from ISR, same as embeddedCliReceiveChar.
+ * @param mux
+ * @param c - received byte
+ */
+void embeddedCliMuxReceiveChar(EmbeddedCliMux *mux, char c);
+
+/**
+ * Write raw bytes to channel (for example, log messages). Should be called
+ * from the same place as embeddedCliMuxProcess
+ * @param mux
+ * @param channel
+ * @param data
+ * @param size
+ */
+void embeddedCliMuxWrite(EmbeddedCliMux *mux, uint8_t channel, const char *data, uint16_t size);
+
+/**
+ * Process all attached clis and write collected output of all channels.
+ * Should be called instead of embeddedCliProcess for attached clis.
+ * @param mux
+ * @return true if some attached cli has pending work
+ */
+bool embeddedCliMuxProcess(EmbeddedCliMux *mux);
+
+/**
+ * Free allocated for mux memory. Attached clis are not freed
+ * @param mux
+ */
+void embeddedCliMuxFree(EmbeddedCliMux *mux);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,338 @@
+#ifndef EMBEDDED_CLI_HPP
+#define EMBEDDED_CLI_HPP
+
+// C++20 adapter that allows bindings to be coroutines. No heap is used:
+// coroutine frames are allocated from fixed pool of each CoroutinePool.
+
+#include "embedded_cli.h"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+namespace embedded_cli {
+
+class Coroutines;
+
+/**
+ * Return type of coroutine binding. Coroutine starts immediately when
+ * command is received and runs until first suspension inside binding call.
+ * Frame is destroyed automatically when coroutine finishes.
+ */
+class Task {
+public:
+    struct promise_type {
+        Task get_return_object() noexcept {
+            return Task(true);
+        }
+
+        static Task get_return_object_on_allocation_failure() noexcept {
+            return Task(false);
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+
+        /**
+         * Frame is allocated from pool of cli that receives command
+         */
+        static void *operator new(std::size_t size, Coroutines &coroutines, char *args) noexcept;
+
+        static void operator delete(void *ptr, std::size_t size) noexcept;
+    };
+
+    /**
+     * @return false if there was no free frame for coroutine
+     */
+    bool isStarted() const {
+        return started;
+    }
+
+private:
+    explicit Task(bool started) : started(started) {}
+
+    bool started;
+};
+
+/**
+ * Event that can be awaited by coroutine binding. It can be set from any
+ * place (callback, interrupt or other thread), waiting coroutine is resumed
+ * from the next call to Coroutines::process. Only one coroutine can wait for
+ * event at a time.
+ */
+class Event {
+public:
+    void set() {
+        ready.store(true, std::memory_order_release);
+    }
+
+    bool isSet() const {
+        return ready.load(std::memory_order_acquire);
+    }
+
+    void reset() {
+        ready.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool> ready{false};
+};
+
+/**
+ * Per cli state of coroutine bindings (use CoroutinePool to create it).
+ * Reference to it is the first argument of each coroutine binding:
+ *
+ * embedded_cli::Task onRead(embedded_cli::Coroutines &co, char *args) {
+ *     startTransfer();
+ *     co_await co.wait(transferDone);
+ *     co.print("done");
+ * }
+ *
+ * Args are stored in cli buffer, so they are valid only until first
+ * suspension. Copy them to local variables if they are needed later.
+ */
+class Coroutines {
+public:
+    using Binding = Task (*)(Coroutines &coroutines, char *args);
+
+    Coroutines(const Coroutines &) = delete;
+
+    Coroutines &operator=(const Coroutines &) = delete;
+
+    /**
+     * Add binding that is implemented as coroutine
+     * @param name - name of command
+     * @param help - help string (can be nullptr)
+     * @param tokenizeArgs - whether args should be tokenized before call
+     * @param binding - coroutine function
+     * @return true if binding was added
+     */
+    bool addBinding(const char *name, const char *help, bool tokenizeArgs, Binding binding) {
+        if (entriesCount == maxEntries)
+            return false;
+
+        Entry &entry = entries[entriesCount];
+        entry.owner = this;
+        entry.binding = binding;
+
+        CliCommandBinding b;
+        b.name = name;
+        b.help = help;
+        b.tokenizeArgs = tokenizeArgs;
+        b.context = &entry;
+        b.binding = onBinding;
+        if (!embeddedCliAddBinding(cli, b))
+            return false;
+        ++entriesCount;
+        return true;
+    }
+
+    /**
+     * Resume suspended coroutines which awaited condition is fulfilled.
+     * Should be called from the same place as embeddedCliProcess (for
+     * example, right after it).
+     */
+    void process() {
+        // coroutines that are suspended during this call are resumed only
+        // by the next one
+        ++pass;
+        for (std::size_t i = 0; i < framesCount; ++i) {
+            Waiting &w = waiting[i];
+            if (!w.handle || w.pass == pass || (w.event != nullptr && !w.event->isSet()))
+                continue;
+            if (w.event != nullptr)
+                w.event->reset();
+            std::coroutine_handle<> handle = w.handle;
+            w.handle = nullptr;
+            handle.resume();
+        }
+    }
+
+    /**
+     * Print line through cli. Can be used from any part of coroutine
+     * @param line
+     */
+    void print(const char *line) {
+        embeddedCliPrint(cli, line);
+    }
+
+    /**
+     * @return cli, that calls bindings
+     */
+    EmbeddedCli *raw() {
+        return cli;
+    }
+
+    /**
+     * Awaitable that suspends coroutine until next call to process
+     */
+    auto nextProcess() {
+        return Awaiter{this, nullptr};
+    }
+
+    /**
+     * Awaitable that suspends coroutine until event is set. If event is
+     * already set, coroutine is not suspended. Event is reset when it is
+     * consumed
+     * @param event
+     */
+    auto wait(Event &event) {
+        return Awaiter{this, &event};
+    }
+
+    /**
+     * @return number of coroutines that are not finished yet
+     */
+    std::size_t activeCount() const {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < framesCount; ++i) {
+            if (frameUsed[i])
+                ++count;
+        }
+        return count;
+    }
+
+protected:
+    struct Entry {
+        Coroutines *owner;
+        Binding binding;
+    };
+
+    struct Waiting {
+        std::coroutine_handle<> handle;
+        Event *event;
+        unsigned int pass;
+    };
+
+    /**
+     * Header is stored before each frame so frame can be returned to pool
+     */
+    union FrameHeader {
+        Coroutines *owner;
+        std::max_align_t alignment;
+    };
+
+    Coroutines(EmbeddedCli *cli, unsigned char *frames, bool *frameUsed, Waiting *waiting,
+               std::size_t frameSize, std::size_t framesCount, Entry *entries, std::size_t maxEntries)
+            : cli(cli), frames(frames), frameUsed(frameUsed), waiting(waiting), frameSize(frameSize),
+              framesCount(framesCount), entries(entries), maxEntries(maxEntries) {}
+
+private:
+    friend struct Task::promise_type;
+
+    struct Awaiter {
+        Coroutines *owner;
+        Event *event;
+
+        bool await_ready() {
+            if (event == nullptr || !event->isSet())
+                return false;
+            event->reset();
+            return true;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            // each active coroutine has its own frame, so there is always
+            // free slot
+            for (std::size_t i = 0; i < owner->framesCount; ++i) {
+                Waiting &w = owner->waiting[i];
+                if (!w.handle) {
+                    w.handle = handle;
+                    w.event = event;
+                    w.pass = owner->pass;
+                    return;
+                }
+            }
+        }
+
+        void await_resume() {}
+    };
+
+    EmbeddedCli *cli;
+    unsigned char *frames;
+    bool *frameUsed;
+    Waiting *waiting;
+    std::size_t frameSize;
+    std::size_t framesCount;
+    Entry *entries;
+    std::size_t maxEntries;
+    std::size_t entriesCount = 0;
+    unsigned int pass = 0;
+
+    void *allocate(std::size_t size) {
+        if (size > frameSize)
+            return nullptr;
+        for (std::size_t i = 0; i < framesCount; ++i) {
+            if (frameUsed[i])
+                continue;
+            frameUsed[i] = true;
+            auto *header = (FrameHeader *) (frames + i * (sizeof(FrameHeader) + frameSize));
+            header->owner = this;
+            return header + 1;
+        }
+        return nullptr;
+    }
+
+    void release(void *ptr) {
+        auto *frame = (unsigned char *) ptr - sizeof(FrameHeader);
+        frameUsed[(std::size_t) (frame - frames) / (sizeof(FrameHeader) + frameSize)] = false;
+    }
+
+    static void onBinding(EmbeddedCli *cli, char *args, void *context) {
+        auto *entry = (Entry *) context;
+        Task task = entry->binding(*entry->owner, args);
+        if (!task.isStarted()) {
+            embeddedCliPrint(cli, "Not enough memory to start command");
+            embeddedCliCommandFailed(cli);
+        }
+    }
+};
+
+/**
+ * Coroutines with static storage for frames.
+ * @tparam FrameSize - maximum size of single coroutine frame (depends on
+ * local variables of coroutine, exact size is compiler specific)
+ * @tparam FrameCount - maximum number of coroutines running at the same time
+ * @tparam BindingCount - maximum number of coroutine bindings
+ */
+template<std::size_t FrameSize, std::size_t FrameCount, std::size_t BindingCount = 8>
+class CoroutinePool : public Coroutines {
+public:
+    explicit CoroutinePool(EmbeddedCli *cli)
+            : Coroutines(cli, storage, used, waitingStorage, alignedFrameSize, FrameCount,
+                         entryStorage, BindingCount) {}
+
+private:
+    static constexpr std::size_t alignedFrameSize =
+            (FrameSize + sizeof(FrameHeader) - 1) / sizeof(FrameHeader) * sizeof(FrameHeader);
+
+    alignas(FrameHeader) unsigned char storage[FrameCount * (sizeof(FrameHeader) + alignedFrameSize)]{};
+    bool used[FrameCount]{};
+    Waiting waitingStorage[FrameCount]{};
+    Entry entryStorage[BindingCount]{};
+};
+
+inline void *Task::promise_type::operator new(std::size_t size, Coroutines &coroutines, char *) noexcept {
+    return coroutines.allocate(size);
+}
+
+inline void Task::promise_type::operator delete(void *ptr, std::size_t) noexcept {
+    auto *header = (Coroutines::FrameHeader *) ptr - 1;
+    header->owner->release(ptr);
+}
+
+}
+
+#endif //EMBEDDED_CLI_HPP
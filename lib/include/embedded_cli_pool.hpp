@@ -0,0 +1,234 @@
+#ifndef EMBEDDED_CLI_POOL_HPP
+#define EMBEDDED_CLI_POOL_HPP
+
+// Host-only helper (requires C++11 and threads). Not used on MCUs.
+
+#include "embedded_cli.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace embedded_cli {
+
+/**
+ * Output of command that is executed by WorkerPool. It is collected while
+ * command is running and printed through cli when all previously submitted
+ * commands are printed.
+ */
+class PoolOutput {
+public:
+    /**
+     * Append line to output (line ending is added when it is printed)
+     * @param line
+     */
+    void print(const std::string &line) {
+        lines.push_back(line);
+    }
+
+private:
+    friend class WorkerPool;
+
+    std::vector<std::string> lines;
+};
+
+/**
+ * Executes slow bindings on worker threads, so embeddedCliProcess is not
+ * blocked by them. Binding added through pool only copies its arguments and
+ * returns, actual function is called on one of the workers. Output of each
+ * command is printed from process() in the same order as commands were
+ * submitted.
+ * Pool must outlive cli usage, since bindings point to it. Commands that
+ * are not started yet when pool is destroyed are discarded.
+ */
+class WorkerPool {
+public:
+    /**
+     * Function of offloaded binding. Called from worker thread, so it must
+     * not use cli, all output goes to provided PoolOutput.
+     * @param output - output of this command
+     * @param args - string of args (if tokenizeArgs is false) or tokens
+     * otherwise. nullptr if command doesn't have args
+     */
+    using Binding = std::function<void(PoolOutput &output, char *args)>;
+
+    /**
+     * Create pool with given amount of worker threads
+     * @param cli - cli that will call bindings and print output
+     * @param threadCount
+     */
+    WorkerPool(EmbeddedCli *cli, size_t threadCount) : cli(cli) {
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * Add binding to cli that is executed by worker pool
+     * @param name - name of command
+     * @param help - help string (can be nullptr)
+     * @param tokenizeArgs - whether args should be tokenized before call
+     * @param binding - function to call
+     * @return true if binding was added to cli
+     */
+    bool addBinding(const char *name, const char *help, bool tokenizeArgs, Binding binding) {
+        entries.push_back({this, name, help != nullptr ? help : "", help != nullptr, std::move(binding)});
+        Entry &entry = entries.back();
+
+        CliCommandBinding b;
+        b.name = entry.name.c_str();
+        b.help = entry.hasHelp ? entry.help.c_str() : nullptr;
+        b.tokenizeArgs = tokenizeArgs;
+        b.context = &entry;
+        b.binding = onBinding;
+        if (!embeddedCliAddBinding(cli, b)) {
+            entries.pop_back();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Print output of finished commands. Must be called from the same place
+     * as embeddedCliProcess (for example, right after it).
+     */
+    void process() {
+        std::vector<std::shared_ptr<Command>> finished;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // output is printed only in order of submission
+            while (!submitted.empty() && submitted.front()->finished) {
+                finished.push_back(std::move(submitted.front()));
+                submitted.pop_front();
+            }
+        }
+
+        for (auto &command: finished) {
+            for (auto &line: command->output.lines) {
+                embeddedCliPrint(cli, line.c_str());
+            }
+        }
+    }
+
+    /**
+     * @return number of submitted commands which output is not printed yet
+     */
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return submitted.size();
+    }
+
+private:
+    struct Entry {
+        WorkerPool *pool;
+        std::string name;
+        std::string help;
+        bool hasHelp;
+        Binding binding;
+    };
+
+    struct Command {
+        Entry *entry = nullptr;
+        /**
+         * Copy of args including both ending null chars
+         */
+        std::vector<char> args;
+        PoolOutput output;
+        bool finished = false;
+    };
+
+    EmbeddedCli *cli;
+
+    /**
+     * Added bindings. List is used so pointers to entries stay valid
+     */
+    std::list<Entry> entries;
+
+    std::mutex mutex;
+
+    std::condition_variable condition;
+
+    /**
+     * All commands which output is not printed yet, in submission order
+     */
+    std::deque<std::shared_ptr<Command>> submitted;
+
+    /**
+     * Commands that are not started yet
+     */
+    std::deque<std::shared_ptr<Command>> queue;
+
+    std::vector<std::thread> workers;
+
+    bool stopping = false;
+
+    static void onBinding(EmbeddedCli *, char *args, void *context) {
+        auto *entry = (Entry *) context;
+        auto command = std::make_shared<Command>();
+        command->entry = entry;
+
+        // args live in cli buffer only during this call, so they are copied
+        // (both tokens and raw args end with double null char)
+        if (args != nullptr) {
+            size_t len = 0;
+            while (args[len] != '\0' || args[len + 1] != '\0')
+                ++len;
+            command->args.assign(args, args + len + 2);
+        }
+
+        WorkerPool *pool = entry->pool;
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            pool->submitted.push_back(command);
+            pool->queue.push_back(command);
+        }
+        pool->condition.notify_one();
+    }
+
+    void work() {
+        while (true) {
+            std::shared_ptr<Command> command;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (stopping)
+                    return;
+                command = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            char *args = command->args.empty() ? nullptr : command->args.data();
+            command->entry->binding(command->output, args);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            command->finished = true;
+        }
+    }
+};
+
+}
+
+#endif //EMBEDDED_CLI_POOL_HPP
@@ -5,8 +5,44 @@
 
 #define CLI_TOKEN_NPOS 0xffff
 
+/**
+ * Index of radix tree node (or binding) that doesn't exist
+ */
+#define CLI_RADIX_NONE 0xffff
+
 #define UNUSED(x) (void)x
 
+/**
+ * Strings are scanned and compared by whole words (CLI_UINT) unless
+ * EMBEDDED_CLI_BYTEWISE_STRINGS is defined. Word scan reads aligned words, so
+ * up to CLI_UINT_SIZE - 1 bytes after the end of string can be read (without
+ * crossing word boundary). Such reads are reported by AddressSanitizer, so
+ * bytewise versions are also used under it.
+ */
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define CLI_ADDRESS_SANITIZER
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define CLI_ADDRESS_SANITIZER
+#endif
+
+#if !defined(EMBEDDED_CLI_BYTEWISE_STRINGS) && !defined(CLI_ADDRESS_SANITIZER)
+#define CLI_WORD_STRINGS
+#endif
+
+/**
+ * Word with all bytes equal to 0x01 and word with all bytes equal to 0x80
+ */
+#define CLI_WORD_ONES ((CLI_UINT) ~(CLI_UINT) 0 / 0xFFu)
+#define CLI_WORD_HIGHS ((CLI_UINT) (CLI_WORD_ONES * 0x80u))
+
+/**
+ * Returns non zero if any byte of word is zero
+ */
+#define CLI_WORD_HAS_ZERO(w) (((w) - CLI_WORD_ONES) & (CLI_UINT) ~(w) & CLI_WORD_HIGHS)
+
 #define PREPARE_IMPL(t) \
   EmbeddedCliImpl* impl = (EmbeddedCliImpl*)t->_impl
 
@@ -16,12 +52,146 @@
 
 #define UNSET_U8FLAG(flags, flag) ((flags) &= (uint8_t) ~(flag))
 
+#define UNSET_U16FLAG(flags, flag) ((flags) &= (uint16_t) ~(flag))
+
 /**
  * Marks binding as candidate for autocompletion
  * This flag is updated each time getAutocompletedCommand is called
  */
 #define BINDING_FLAG_AUTOCOMPLETE 1u
 
+/**
+ * Marks internal binding (help, stats, watch). Internal bindings are called
+ * while cli is locked, since they only access cli itself
+ */
+#define BINDING_FLAG_INTERNAL 2u
+
+/**
+ * Maximum number of output filters after single command
+ */
+#define CLI_MAX_FILTERS 4
+
+/**
+ * Types of output filters
+ * CLI_FILTER_GREP - pass only lines that contain pattern
+ * CLI_FILTER_HEAD - pass only first lines
+ * CLI_FILTER_COUNT - drop all lines and print their count at the end
+ */
+#define CLI_FILTER_GREP 1u
+#define CLI_FILTER_HEAD 2u
+#define CLI_FILTER_COUNT 3u
+
+/**
+ * Max amount of non-zero bytes in single COBS block
+ */
+#define CLI_FRAME_BLOCK_SIZE 254u
+
+/**
+ * Initial value of CRC-16/CCITT-FALSE used in frames
+ */
+#define CLI_FRAME_CRC_INIT 0xFFFFu
+
+/**
+ * State of frame receiving in EmbeddedCliMux
+ * CLI_MUX_RX_SYNC - bytes are discarded until next delimiter
+ * CLI_MUX_RX_TAG - waiting for tag (first decoded byte of frame)
+ * CLI_MUX_RX_PAYLOAD - receiving payload
+ */
+#define CLI_MUX_RX_SYNC 0u
+#define CLI_MUX_RX_TAG 1u
+#define CLI_MUX_RX_PAYLOAD 2u
+
+/**
+ * Maximum amount of non-zero bytes in single COBS block
+ */
+#define CLI_COBS_MAX_BLOCK 254u
+
+/**
+ * Telnet commands and options (RFC 854, 857, 858, 1073)
+ */
+#define CLI_TELNET_IAC 0xFFu
+#define CLI_TELNET_DONT 0xFEu
+#define CLI_TELNET_DO 0xFDu
+#define CLI_TELNET_WONT 0xFCu
+#define CLI_TELNET_WILL 0xFBu
+#define CLI_TELNET_SB 0xFAu
+#define CLI_TELNET_SE 0xF0u
+#define CLI_TELNET_OPT_ECHO 1u
+#define CLI_TELNET_OPT_SGA 3u
+#define CLI_TELNET_OPT_NAWS 31u
+
+/**
+ * State of telnet input
+ * CLI_TELNET_DATA - plain data
+ * CLI_TELNET_CR - after \r (client might send \r\0 for return)
+ * CLI_TELNET_COMMAND - after IAC
+ * CLI_TELNET_OPTION - after IAC and WILL, WONT, DO or DONT
+ * CLI_TELNET_SB_OPTION - after IAC SB
+ * CLI_TELNET_SB_DATA - inside subnegotiation
+ * CLI_TELNET_SB_IAC - after IAC inside subnegotiation
+ */
+#define CLI_TELNET_DATA 0u
+#define CLI_TELNET_CR 1u
+#define CLI_TELNET_COMMAND 2u
+#define CLI_TELNET_OPTION 3u
+#define CLI_TELNET_SB_OPTION 4u
+#define CLI_TELNET_SB_DATA 5u
+#define CLI_TELNET_SB_IAC 6u
+
+/**
+ * Enabled telnet options
+ * CLI_TELNET_ECHO - server echoes input
+ * CLI_TELNET_SGA - server doesn't send go-ahead
+ * CLI_TELNET_CLIENT_SGA - client doesn't send go-ahead
+ * CLI_TELNET_NAWS - client reports window size
+ */
+#define CLI_TELNET_ECHO 0x01u
+#define CLI_TELNET_SGA 0x02u
+#define CLI_TELNET_CLIENT_SGA 0x04u
+#define CLI_TELNET_NAWS 0x08u
+
+/**
+ * Size of buffer for telnet replies (each reply takes two bytes)
+ */
+#define CLI_TELNET_REPLIES_SIZE 16u
+
+/**
+ * Types of incrementally generated output
+ * CLI_GENERATOR_NONE - no output is generated
+ * CLI_GENERATOR_HELP - list of all bindings with their help
+ * CLI_GENERATOR_STATS - statistics of all bindings
+ */
+#define CLI_GENERATOR_NONE 0u
+#define CLI_GENERATOR_HELP 1u
+#define CLI_GENERATOR_STATS 2u
+
+/**
+ * State of escape sequence in received chars
+ * CLI_RX_ESCAPE_NONE - not inside escape sequence
+ * CLI_RX_ESCAPE_START - escape char received
+ * CLI_RX_ESCAPE_CSI - "ESC [" received, waiting for final char
+ */
+#define CLI_RX_ESCAPE_NONE 0u
+#define CLI_RX_ESCAPE_START 1u
+#define CLI_RX_ESCAPE_CSI 2u
+
+/**
+ * Layout of saved state (all numbers are little endian):
+ * magic, version, flags, last char, cmd size (u16), input line length (u16),
+ * history items count (u16), history size (u16), then cmd, history and
+ * Fletcher-16 checksum (u16) of all previous bytes
+ */
+#define CLI_STATE_MAGIC 0xC1u
+#define CLI_STATE_VERSION 1u
+#define CLI_STATE_HEADER_SIZE 12u
+#define CLI_STATE_CHECKSUM_SIZE 2u
+
+/**
+ * Flags of saved state
+ * CLI_STATE_FLAG_INIT_COMPLETE - invitation was already printed
+ */
+#define CLI_STATE_FLAG_INIT_COMPLETE 0x01u
+
 /**
  * Indicates that rx buffer overflow happened. In such case last command
  * that wasn't finished (no \r or \n were received) will be discarded
@@ -57,10 +227,74 @@
  */
 #define CLI_FLAG_AUTOCOMPLETE_ENABLED 0x20u
 
+/**
+ * Indicates that currently executed binding reported failure
+ */
+#define CLI_FLAG_COMMAND_FAILED 0x40u
+
+/**
+ * Indicates that command is executed. Bindings are called while cli is
+ * unlocked, so other commands are not started until this one finishes
+ * (they would replace command cli and flags of current command)
+ */
+#define CLI_FLAG_EXECUTING 0x80u
+
+/**
+ * Indicates that multiple commands can be chained with ;, && and ||
+ */
+#define CLI_FLAG_CHAINING_ENABLED 0x100u
+
+/**
+ * Indicates that output of watched commands is displayed instead of
+ * invitation and current command
+ */
+#define CLI_FLAG_WATCH_SCREEN 0x200u
+
+/**
+ * Indicates that single command typed by user is executed, so its large
+ * output can be generated incrementally
+ */
+#define CLI_FLAG_INTERACTIVE 0x400u
+
+/**
+ * Indicates that input is decoded as framed requests instead of text
+ */
+#define CLI_FLAG_FRAMED 0x800u
+
+/**
+ * Indicates that received bytes are discarded until next frame delimiter
+ */
+#define CLI_FLAG_FRAME_SYNC 0x1000u
+
+/**
+ * Indicates that current request didn't fit into frame buffer
+ */
+#define CLI_FLAG_FRAME_OVERFLOW 0x2000u
+
+/**
+ * Indicates that output of executed command is discarded, so invitation and
+ * current command are still on the screen
+ */
+#define CLI_FLAG_HIDDEN_OUTPUT 0x4000u
+
+/**
+ * Indicates that embeddedCliProcess was skipped while command was executed
+ * from other task, so host has to be notified when command finishes
+ */
+#define CLI_FLAG_INPUT_DEFERRED 0x8000u
+
 typedef struct EmbeddedCliImpl EmbeddedCliImpl;
 typedef struct AutocompletedCommand AutocompletedCommand;
 typedef struct FifoBuf FifoBuf;
 typedef struct CliHistory CliHistory;
+typedef struct CliRadixNode CliRadixNode;
+typedef struct CliRadixTree CliRadixTree;
+typedef struct CliExecution CliExecution;
+typedef struct CliWatch CliWatch;
+typedef struct CliFilter CliFilter;
+typedef struct CliGenerator CliGenerator;
+typedef struct EmbeddedCliMuxImpl EmbeddedCliMuxImpl;
+typedef struct CliMuxChannel CliMuxChannel;
 
 struct FifoBuf {
     char *buf;
@@ -103,6 +337,201 @@ struct CliHistory {
     uint16_t itemsCount;
 };
 
+struct CliRadixNode {
+    /**
+     * Index of binding which name is used as label of this node.
+     * If some binding name ends at this node (node is terminal), this is
+     * index of that binding. Otherwise it is index of any binding from
+     * the subtree of this node.
+     */
+    uint16_t binding;
+
+    /**
+     * Length of name prefix that ends at this node. Label of the node is
+     * a part of binding name between depth of parent and depth of this node
+     */
+    uint16_t depth;
+
+    uint16_t parent;
+
+    uint16_t firstChild;
+
+    uint16_t nextSibling;
+};
+
+struct CliRadixTree {
+    /**
+     * Nodes are addressed by indices, so tree doesn't depend on where
+     * cli buffer is located. First node is always root with empty label
+     */
+    CliRadixNode *nodes;
+
+    /**
+     * Bindings which names are stored in tree
+     */
+    const CliCommandBinding *bindings;
+
+    uint16_t nodesCount;
+
+    uint16_t maxNodesCount;
+
+    /**
+     * First node in list of removed nodes (linked through nextSibling)
+     */
+    uint16_t freeNodes;
+};
+
+struct CliFilter {
+    /**
+     * Pattern for grep filter. Points into command buffer
+     */
+    const char *pattern;
+
+    /**
+     * Lines left for head filter or counted lines for count filter
+     */
+    uint32_t value;
+
+    /**
+     * One of CLI_FILTER_*
+     */
+    uint8_t type;
+};
+
+struct CliWatch {
+    /**
+     * Arguments of watched command, stored once when watch is created (already
+     * tokenized if binding requires it). Points to buffer of cmdBufferSize
+     */
+    char *args;
+
+    /**
+     * Period of execution in getTime units
+     */
+    uint32_t period;
+
+    /**
+     * Time of next execution
+     */
+    uint32_t deadline;
+
+    /**
+     * Index of watched binding or CLI_RADIX_NONE if watch is not active
+     */
+    uint16_t binding;
+
+    /**
+     * Length of arguments including both ending null chars (0 if command
+     * doesn't have arguments)
+     */
+    uint16_t argsLen;
+
+    /**
+     * Number of lines printed by last execution
+     */
+    uint16_t lines;
+};
+
+struct CliGenerator {
+    /**
+     * Original writeChar while next chunk is generated
+     */
+    void (*writeChar)(EmbeddedCli *cli, char c);
+
+    /**
+     * Binding which output is generated now
+     */
+    uint16_t item;
+
+    /**
+     * Amount of already written chars of current item. Item is generated
+     * from the beginning each time, so these chars are skipped
+     */
+    uint16_t offset;
+
+    /**
+     * Chars left to skip while current item is generated
+     */
+    uint16_t skip;
+
+    /**
+     * Chars left to write during current call to embeddedCliProcess
+     */
+    uint16_t budget;
+
+    /**
+     * One of CLI_GENERATOR_*
+     */
+    uint8_t type;
+
+    /**
+     * Whether some chars of current item didn't fit into budget
+     */
+    bool truncated;
+
+    /**
+     * Last written char
+     */
+    char lastChar;
+};
+
+struct CliMuxChannel {
+    EmbeddedCliMux *mux;
+
+    /**
+     * Attached cli (or NULL if channel is used only for raw output)
+     */
+    EmbeddedCli *cli;
+
+    /**
+     * Output that is not written in frames yet
+     */
+    FifoBuf txBuffer;
+
+    uint8_t id;
+};
+
+struct EmbeddedCliMuxImpl {
+    CliMuxChannel *channels;
+
+    uint8_t channelCount;
+
+    uint8_t maxPayloadSize;
+
+    /**
+     * Channel that writes first frame during next process, so channels with
+     * lower ids don't get priority
+     */
+    uint8_t nextChannel;
+
+    /**
+     * Channel of currently received frame
+     */
+    uint8_t rxChannel;
+
+    /**
+     * COBS code of current block of received frame
+     */
+    uint8_t rxCode;
+
+    /**
+     * Bytes left in current block of received frame
+     */
+    uint8_t rxLeft;
+
+    /**
+     * One of CLI_MUX_RX_*
+     */
+    uint8_t rxState;
+
+    /**
+     * Whether delimiter before the first frame was written
+     */
+    bool started;
+
+    bool allocated;
+};
+
 struct EmbeddedCliImpl {
     /**
      * Invitation string. Is printed at the beginning of each line with user
@@ -123,6 +552,19 @@ struct EmbeddedCliImpl {
      */
     char *cmdBuffer;
 
+    /**
+     * Buffer for commands from embeddedCliExecute, so they don't interfere
+     * with current command. Has the same size as cmdBuffer. Allocated only
+     * if execution is enabled or watches are used (they copy args here),
+     * otherwise NULL
+     */
+    char *execBuffer;
+
+    /**
+     * Whether embeddedCliExecute and embeddedCliRunScript can be used
+     */
+    bool executeEnabled;
+
     /**
      * Size of current command
      */
@@ -140,746 +582,3671 @@ struct EmbeddedCliImpl {
      */
     uint8_t *bindingsFlags;
 
-    uint16_t bindingsCount;
+    /**
+     * Call statistics for each binding. Sizes are the same as for bindings
+     * array. NULL if statistics are disabled
+     */
+    CliBindingStats *bindingsStats;
 
-    uint16_t maxBindingsCount;
+    /**
+     * Radix tree over binding names, used for lookup and autocompletion
+     */
+    CliRadixTree bindingsTree;
 
     /**
-     * Total length of input line. This doesn't include invitation but
-     * includes current command and its live autocompletion
+     * Root of the subtree with bindings that are marked as autocompletion
+     * candidates in bindingsFlags (or CLI_RADIX_NONE if there are none)
      */
-    uint16_t inputLineLength;
+    uint16_t candidatesRoot;
 
     /**
-     * Stores last character that was processed.
+     * Watched commands. Output of active watches is displayed in order of
+     * this array, each watch redraws only its own lines
      */
-    char lastChar;
+    CliWatch *watches;
 
     /**
-     * Flags are defined as CLI_FLAG_*
+     * Original writeChar while watched command is executed
      */
-    uint8_t flags;
-};
+    void (*watchWriteChar)(EmbeddedCli *cli, char c);
+
+    uint16_t maxWatchesCount;
 
-struct AutocompletedCommand {
     /**
-     * Name of autocompleted command (or first candidate for autocompletion if
-     * there are multiple candidates).
-     * NULL if autocomplete not possible.
+     * Number of active watches
      */
-    const char *firstCandidate;
+    uint16_t watchesCount;
 
     /**
-     * Number of characters that can be completed safely. For example, if there
-     * are two possible commands "get-led" and "get-adc", then for prefix "g"
-     * autocompletedLen will be 4. If there are only one candidate, this number
-     * is always equal to length of the command.
+     * Number of lines printed by currently executed watch
      */
-    uint16_t autocompletedLen;
+    uint16_t watchLines;
+
+    uint16_t ticksPerMs;
 
     /**
-     * Total number of candidates for autocompletion
+     * Last char printed by currently executed watch
      */
-    uint16_t candidateCount;
-};
+    char watchLastChar;
 
-static EmbeddedCliConfig defaultConfig;
+    /**
+     * Output filters of currently executed command
+     */
+    CliFilter filters[CLI_MAX_FILTERS];
 
-/**
- * Number of commands that cli adds. Commands:
- * - help
- */
-static const uint16_t cliInternalBindingCount = 1;
+    /**
+     * Buffer for single line of filtered output. NULL if filters are disabled
+     */
+    char *filterBuffer;
 
-static const char *lineBreak = "\r\n";
+    /**
+     * Original writeChar while filtered command is executed
+     */
+    void (*filterWriteChar)(EmbeddedCli *cli, char c);
 
-/**
- * Navigate through command history back and forth. If navigateUp is true,
- * navigate to older commands, otherwise navigate to newer.
- * When history end is reached, nothing happens.
- * @param cli
- * @param navigateUp
- */
-static void navigateHistory(EmbeddedCli *cli, bool navigateUp);
+    uint16_t filterBufferSize;
 
-/**
- * Process escaped character. After receiving ESC+[ sequence, all chars up to
- * ending character are sent to this function
- * @param cli
- * @param c
- */
-static void onEscapedInput(EmbeddedCli *cli, char c);
+    /**
+     * Length of line currently stored in filter buffer
+     */
+    uint16_t filterLineLength;
+
+    /**
+     * Number of filters of currently executed command
+     */
+    uint8_t filtersCount;
+
+    /**
+     * Large output (help or stats) that is written in chunks
+     */
+    CliGenerator generator;
+
+    /**
+     * Maximum amount of generated chars per call to embeddedCliProcess (0 if
+     * output is written at once)
+     */
+    uint16_t outputChunkSize;
+
+    /**
+     * Buffer for decoded request in framed mode. NULL if framed mode is not
+     * available
+     */
+    uint8_t *frameBuffer;
+
+    /**
+     * Non-zero bytes of response that are not encoded yet. Has
+     * CLI_FRAME_BLOCK_SIZE bytes
+     */
+    uint8_t *frameBlock;
+
+    /**
+     * Original writeChar while response is written
+     */
+    void (*frameWriteChar)(EmbeddedCli *cli, char c);
+
+    uint16_t frameBufferSize;
+
+    /**
+     * Amount of decoded bytes of current request
+     */
+    uint16_t frameSize;
+
+    /**
+     * CRC of response bytes written so far
+     */
+    uint16_t frameCrc;
+
+    /**
+     * COBS code of current block of request
+     */
+    uint8_t frameCode;
+
+    /**
+     * Bytes left in current block of request
+     */
+    uint8_t frameLeft;
+
+    /**
+     * Amount of bytes in frameBlock
+     */
+    uint8_t frameBlockSize;
+
+    /**
+     * Telnet replies (command and option) that are written from process
+     */
+    FifoBuf telnetReplies;
+
+    char telnetRepliesBuf[CLI_TELNET_REPLIES_SIZE];
+
+    /**
+     * Original writeChar in telnet session (NULL if session isn't started)
+     */
+    void (*telnetWriteChar)(EmbeddedCli *cli, char c);
+
+    /**
+     * Bytes of current subnegotiation
+     */
+    uint8_t telnetSb[4];
+
+    /**
+     * Amount of bytes in telnetSb
+     */
+    uint8_t telnetSbSize;
+
+    /**
+     * One of CLI_TELNET_* states
+     */
+    uint8_t telnetState;
+
+    /**
+     * Last received command or option of subnegotiation
+     */
+    uint8_t telnetCommand;
+
+    /**
+     * Combination of enabled CLI_TELNET_* options
+     */
+    uint8_t telnetOptions;
+
+    /**
+     * Window width reported by telnet client (0 if unknown)
+     */
+    uint16_t windowWidth;
+
+    /**
+     * Channel of mux that this cli is attached to (or NULL)
+     */
+    CliMuxChannel *muxChannel;
+
+    /**
+     * Dictionary of compressed help strings from config
+     */
+    const char *const *helpDictionary;
+
+    /**
+     * Combination of CLI_INPUT_READY_* flags from config
+     */
+    uint8_t inputReadyTriggers;
+
+    /**
+     * State of escape sequence in received chars (one of CLI_RX_ESCAPE_*).
+     * Used only by embeddedCliReceiveChar, so it doesn't depend on how far
+     * processing went.
+     */
+    uint8_t rxEscapeState;
+
+    /**
+     * Optional lock hooks from config
+     */
+    void (*lock)(EmbeddedCli *cli);
+
+    void (*unlock)(EmbeddedCli *cli);
+
+    /**
+     * Copy of cli that is used while command is executed. Redirects of
+     * command output (filters, watches, frames) replace only its writeChar,
+     * so output printed by other tasks still goes to writeChar of cli
+     */
+    EmbeddedCli commandCli;
+
+    /**
+     * Number of added bindings
+     */
+    uint16_t bindingsCount;
+
+    /**
+     * Number of slots in bindings array that were used. Slots of removed
+     * bindings have NULL name and are reused by next added bindings, so
+     * other bindings never change their place.
+     */
+    uint16_t bindingSlotsCount;
+
+    /**
+     * First slot in list of removed bindings (or CLI_RADIX_NONE)
+     */
+    uint16_t freeBindings;
+
+    /**
+     * Next slot in list of removed bindings for each removed slot
+     */
+    uint16_t *nextFreeBindings;
+
+    uint16_t maxBindingsCount;
+
+    /**
+     * Total length of input line. This doesn't include invitation but
+     * includes current command and its live autocompletion
+     */
+    uint16_t inputLineLength;
+
+    /**
+     * Stores last character that was processed.
+     */
+    char lastChar;
+
+    /**
+     * Flags are defined as CLI_FLAG_*
+     */
+    uint16_t flags;
+};
+
+struct CliExecution {
+    /**
+     * Original writeChar of cli. It is replaced while output is discarded
+     */
+    void (*writeChar)(EmbeddedCli *cli, char c);
+
+    /**
+     * Whether current input should be printed again after execution
+     */
+    bool redraw;
+};
+
+struct AutocompletedCommand {
+    /**
+     * Name of autocompleted command (or first candidate for autocompletion if
+     * there are multiple candidates).
+     * NULL if autocomplete not possible.
+     */
+    const char *firstCandidate;
+
+    /**
+     * Number of characters that can be completed safely. For example, if there
+     * are two possible commands "get-led" and "get-adc", then for prefix "g"
+     * autocompletedLen will be 4. If there are only one candidate, this number
+     * is always equal to length of the command.
+     */
+    uint16_t autocompletedLen;
+
+    /**
+     * Total number of candidates for autocompletion
+     */
+    uint16_t candidateCount;
+};
 
 /**
- * Process input character. Character is valid displayable char and should be
- * added to current command string and displayed to client.
+ * Process single telnet byte that is not plain data
  * @param cli
- * @param c
+ * @param b
  */
-static void onCharInput(EmbeddedCli *cli, char c);
+static void onTelnetInput(EmbeddedCli *cli, uint8_t b);
 
 /**
- * Process control character (like \r or \n) possibly altering state of current
- * command or executing onCommand callback.
+ * Process received option negotiation and queue reply if option state
+ * is changed
  * @param cli
- * @param c
+ * @param command - WILL, WONT, DO or DONT
+ * @param option
  */
-static void onControlInput(EmbeddedCli *cli, char c);
+static void onTelnetOption(EmbeddedCli *cli, uint8_t command, uint8_t option);
 
 /**
- * Parse command in buffer and execute callback
+ * Queue reply to telnet client. Reply is written from process
  * @param cli
+ * @param command
+ * @param option
  */
-static void parseCommand(EmbeddedCli *cli);
+static void queueTelnetReply(EmbeddedCli *cli, uint8_t command, uint8_t option);
 
 /**
- * Setup bindings for internal commands, like help
+ * Write telnet command with option directly to client
  * @param cli
+ * @param command
+ * @param option
  */
-static void initInternalBindings(EmbeddedCli *cli);
+static void writeTelnetCommand(EmbeddedCli *cli, uint8_t command, uint8_t option);
 
 /**
- * Show help for given tokens (or default help if no tokens)
+ * Used as writeChar in telnet session. Escapes IAC bytes of output
  * @param cli
- * @param tokens
- * @param context - not used
+ * @param c
  */
-static void onHelp(EmbeddedCli *cli, char *tokens, void *context);
+static void writeTelnetOutput(EmbeddedCli *cli, char c);
 
 /**
- * Show error about unknown command
+ * Used as writeChar of cli attached to mux. Char is added to output buffer
+ * of channel
  * @param cli
- * @param name
+ * @param c
  */
-static void onUnknownCommand(EmbeddedCli *cli, const char *name);
+static void writeMuxOutput(EmbeddedCli *cli, char c);
 
 /**
- * Return autocompleted command for given prefix.
- * Prefix is compared to all known command bindings and autocompleted result
- * is returned
- * @param cli
- * @param prefix
- * @return
+ * Write single frame from output buffer of channel
+ * @param mux
+ * @param channel
  */
-static AutocompletedCommand getAutocompletedCommand(EmbeddedCli *cli, const char *prefix);
+static void writeMuxFrame(EmbeddedCliMux *mux, CliMuxChannel *channel);
 
 /**
- * Prints autocompletion result while keeping current command unchanged
- * Prints only if autocompletion is present and only one candidate exists.
- * @param cli
+ * Write part of output buffer of channel (it might wrap around end of buffer)
+ * @param mux
+ * @param tx - output buffer of channel
+ * @param offset - offset of part from the front of buffer
+ * @param size - size of part
  */
-static void printLiveAutocompletion(EmbeddedCli *cli);
+static void writeMuxPart(EmbeddedCliMux *mux, FifoBuf *tx, uint16_t offset, uint16_t size);
 
 /**
- * Handles autocomplete request. If autocomplete possible - fills current
- * command with autocompleted command. When multiple commands satisfy entered
- * prefix, they are printed to output.
- * @param cli
+ * Pass decoded byte of received frame to its channel
+ * @param mux
+ * @param b
  */
-static void onAutocompleteRequest(EmbeddedCli *cli);
+static void onMuxInput(EmbeddedCliMux *mux, uint8_t b);
 
 /**
- * Removes all input from current line (replaces it with whitespaces)
- * And places cursor at the beginning of the line
+ * Write single frame from each channel that has output. First channel is
+ * changed each round
+ * @param mux
+ * @return true if any frame was written
+ */
+static bool writeMuxRound(EmbeddedCliMux *mux);
+
+static EmbeddedCliConfig defaultConfig;
+
+
+static const char *lineBreak = "\r\n";
+
+/**
+ * Call lock hook from config (if it is set)
  * @param cli
  */
-static void clearCurrentLine(EmbeddedCli *cli);
+static void lockCli(EmbeddedCli *cli);
 
 /**
- * Write given string to cli output
+ * Call unlock hook from config (if it is set)
  * @param cli
- * @param str
  */
-static void writeToOutput(EmbeddedCli *cli, const char *str);
+static void unlockCli(EmbeddedCli *cli);
 
 /**
- * Returns true if provided char is a supported control char:
- * \r, \n, \b or 0x7F (treated as \b)
- * @param c
- * @return
+ * Check whether input was left by embeddedCliProcess while command was
+ * executed, so onInputReady has to be called (cli must be locked)
+ * @param cli
+ * @return true if onInputReady should be called after unlock
  */
-static bool isControlChar(char c);
+static bool takeDeferredInput(EmbeddedCli *cli);
 
 /**
- * Returns true if provided char is a valid displayable character:
- * a-z, A-Z, 0-9, whitespace, punctuation, etc.
- * Currently only ASCII is supported
- * @param c
- * @return
+ * Implementation of embeddedCliAddBinding (cli must be locked)
+ * @param cli
+ * @param binding
+ * @return true if binding was added
  */
-static bool isDisplayableChar(char c);
+static bool addBinding(EmbeddedCli *cli, CliCommandBinding binding);
 
 /**
- * How many elements are currently available in buffer
- * @param buffer
- * @return number of elements
+ * Implementation of embeddedCliRemoveBinding (cli must be locked)
+ * @param cli
+ * @param name
+ * @return true if binding was removed
  */
-static uint16_t fifoBufAvailable(FifoBuf *buffer);
+static bool removeBinding(EmbeddedCli *cli, const char *name);
 
 /**
- * Return first character from buffer and remove it from buffer
- * Buffer must be non-empty, otherwise 0 is returned
- * @param buffer
- * @return
+ * Implementation of embeddedCliExecute (cli must be locked)
+ * @param cli
+ * @param line
+ * @param flags
+ * @return true if command succeeded
  */
-static char fifoBufPop(FifoBuf *buffer);
+static bool executeLine(EmbeddedCli *cli, const char *line, uint8_t flags);
 
 /**
- * Push character into fifo buffer. If there is no space left, character is
- * discarded and false is returned
- * @param buffer
- * @param a - character to add
- * @return true if char was added to buffer, false otherwise
+ * Prepare cli that is passed to bindings of command that is about to be
+ * executed. Must be called only when no other command is executed
+ * @param cli
+ * @return cli that should be used while command is executed
  */
-static bool fifoBufPush(FifoBuf *buffer, char a);
+static EmbeddedCli *getCommandCli(EmbeddedCli *cli);
 
 /**
- * Copy provided string to the history buffer.
- * If it is already inside history, it will be removed from it and added again.
- * So after addition, it will always be on top
- * If available size is not enough (and total size is enough) old elements will
- * be removed from history so this item can be put to it
- * @param history
- * @param str
- * @return true if string was put in history
+ * Implementation of embeddedCliRunScript (cli must be locked)
+ * @param cli
+ * @param script
+ * @param len
+ * @param options
+ * @return result of execution
  */
-static bool historyPut(CliHistory *history, const char *str);
+static CliScriptResult runScript(EmbeddedCli *cli, const char *script, size_t len,
+                                 const CliScriptOptions *options);
 
 /**
- * Get item from history. Items are counted from 1 so if item is 0 or greater
- * than itemCount, NULL is returned
- * @param history
- * @param item
- * @return true if string was put in history
+ * Navigate through command history back and forth. If navigateUp is true,
+ * navigate to older commands, otherwise navigate to newer.
+ * When history end is reached, nothing happens.
+ * @param cli
+ * @param navigateUp
  */
-static const char *historyGet(CliHistory *history, uint16_t item);
+static void navigateHistory(EmbeddedCli *cli, bool navigateUp);
 
 /**
- * Remove specific item from history
- * @param history
- * @param str - string to remove
- * @return
+ * Process escaped character. After receiving ESC+[ sequence, all chars up to
+ * ending character are sent to this function
+ * @param cli
+ * @param c
  */
-static void historyRemove(CliHistory *history, const char *str);
+static void onEscapedInput(EmbeddedCli *cli, char c);
 
 /**
- * Return position (index of first char) of specified token
- * @param tokenizedStr - tokenized string (separated by \0 with
- * \0\0 at the end)
- * @param pos - token position (counted from 1)
- * @return index of first char of specified token
+ * Process single char received from rx buffer (cli must be locked)
+ * @param cli
+ * @param c
  */
-static uint16_t getTokenPosition(const char *tokenizedStr, uint16_t pos);
+static void processInputChar(EmbeddedCli *cli, char c);
+
+/**
+ * Process input character. Character is valid displayable char and should be
+ * added to current command string and displayed to client.
+ * @param cli
+ * @param c
+ */
+static void onCharInput(EmbeddedCli *cli, char c);
+
+/**
+ * Process control character (like \r or \n) possibly altering state of current
+ * command or executing onCommand callback.
+ * @param cli
+ * @param c
+ */
+static void onControlInput(EmbeddedCli *cli, char c);
+
+/**
+ * Parse command line in buffer and execute callbacks
+ * If chaining is enabled, line is split into separate commands by unquoted
+ * ;, && and || and each of them is executed in place.
+ * Buffer is modified during parsing, it must have two extra bytes after
+ * command, so tokenization is possible
+ * @param cli
+ * @param cmd - buffer with command
+ * @param cmdSize - length of command
+ * @param putToHistory - whether command should be put to history
+ * @return true if (last) command was executed and didn't report failure
+ */
+static bool parseCommand(EmbeddedCli *cli, char *cmd, uint16_t cmdSize, bool putToHistory);
+
+/**
+ * Execute single command with optional output filters ("cmd | grep x")
+ * Buffer must have two extra bytes after command (they are overwritten)
+ * @param cli
+ * @param cmd - buffer with command
+ * @param cmdSize - length of command
+ * @return true if command was executed and didn't report failure
+ */
+static bool executeCommand(EmbeddedCli *cli, char *cmd, uint16_t cmdSize);
+
+/**
+ * Parse single command in buffer and execute callback
+ * Buffer must have two extra bytes after command (they are overwritten)
+ * @param cli
+ * @param cmd - buffer with command
+ * @param cmdSize - length of command
+ * @return true if command was executed and didn't report failure
+ */
+static bool dispatchCommand(EmbeddedCli *cli, char *cmd, uint16_t cmdSize);
+
+/**
+ * Find first separator (";", "&&", "||" or pipe "|") starting from given
+ * position. Separators inside quotes or escaped are skipped the same way as
+ * during tokenization
+ * @param cmd
+ * @param start - position to start search from (must be outside of quotes)
+ * @param cmdSize
+ * @param sepLen - length of found separator (0 if nothing is found)
+ * @return position of separator or cmdSize if nothing is found
+ */
+static uint16_t findSeparator(const char *cmd, uint16_t start, uint16_t cmdSize, uint8_t *sepLen);
+
+/**
+ * Parse filters separated by pipes ("grep x | head 2") and store them in
+ * impl. Buffer is modified so names and patterns are null-terminated
+ * @param cli
+ * @param filters - string with filters, ending with null char
+ * @return true if all filters are valid
+ */
+static bool parseFilters(EmbeddedCli *cli, char *filters);
+
+/**
+ * Used as writeChar while filtered command is executed. Collects output line
+ * in filter buffer and passes it through filters when line is finished
+ * @param cli
+ * @param c
+ */
+static void writeFilteredOutput(EmbeddedCli *cli, char c);
+
+/**
+ * Pass line from filter buffer through filters starting from given one and
+ * print it if no filter dropped it
+ * @param cli
+ * @param filter - index of first filter to apply
+ */
+static void passFilteredLine(EmbeddedCli *cli, uint8_t filter);
+
+/**
+ * Pass remaining output through filters, print results of count filters and
+ * restore original writeChar
+ * @param cli
+ */
+static void finishFilters(EmbeddedCli *cli);
+
+/**
+ * Returns true if given string contains only spaces
+ * @param str
+ * @param len
+ * @return
+ */
+static bool isBlank(const char *str, uint16_t len);
+
+/**
+ * Number of commands that cli adds. Commands:
+ * - help
+ * - stats (only when binding stats are enabled)
+ * @param config
+ * @return
+ */
+static uint16_t getInternalBindingCount(const EmbeddedCliConfig *config);
+
+/**
+ * Returns size of buffer required for given config. Size is not truncated,
+ * so too large configs can be detected
+ * @param config
+ * @return
+ */
+static size_t getRequiredSize(const EmbeddedCliConfig *config);
+
+/**
+ * Whether exec buffer is required for given config. It is used by
+ * embeddedCliExecute, embeddedCliRunScript and watched commands
+ * @param config
+ * @return
+ */
+static bool hasExecBuffer(const EmbeddedCliConfig *config);
+
+/**
+ * Setup bindings for internal commands, like help
+ * @param cli
+ */
+static void initInternalBindings(EmbeddedCli *cli);
+
+/**
+ * Add binding for internal command and mark it as internal
+ * @param cli
+ * @param binding
+ */
+static void addInternalBinding(EmbeddedCli *cli, CliCommandBinding binding);
+
+/**
+ * Call binding at given index, collecting its statistics if enabled.
+ * Cli is unlocked while binding (except for internal ones) is executed
+ * @param cli
+ * @param binding - index of binding
+ * @param args
+ * @return true if binding didn't report failure
+ */
+static bool callBinding(EmbeddedCli *cli, uint16_t binding, char *args);
+
+/**
+ * Prepare cli for execution of commands that don't come from cmd buffer.
+ * Depending on flags, current input is cleared from screen or all output
+ * is discarded.
+ * @param cli
+ * @param flags - CLI_EXECUTE_* flags
+ * @return state that must be provided to finishExecution
+ */
+static CliExecution startExecution(EmbeddedCli *cli, uint8_t flags);
+
+/**
+ * Restore output of cli after execution of commands
+ * @param cli
+ * @param execution - state returned by startExecution
+ */
+static void finishExecution(EmbeddedCli *cli, CliExecution execution);
+
+/**
+ * Execute single line of script. Line is copied to exec buffer only if
+ * there are args or command is not bound to binding function.
+ * @param cli
+ * @param line - line without line ending (not null-terminated)
+ * @param len - length of line
+ * @param flags - CLI_EXECUTE_* flags
+ * @return true if line was executed successfully
+ */
+static bool executeScriptLine(EmbeddedCli *cli, const char *line, uint16_t len, uint8_t flags);
+
+/**
+ * Decode received byte of framed request. When delimiter is received,
+ * request is executed
+ * @param cli
+ * @param c
+ */
+static void onFrameInput(EmbeddedCli *cli, uint8_t c);
+
+/**
+ * Validate decoded request, call requested binding and write response
+ * @param cli
+ */
+static void onFrameReceived(EmbeddedCli *cli);
+
+/**
+ * Write leading delimiter and start response frame. Until response is
+ * finished, all output is written to it
+ * @param cli
+ * @param id - binding id of request
+ */
+static void startFrameResponse(EmbeddedCli *cli, uint16_t id);
+
+/**
+ * Write status and CRC, finish response frame and restore output
+ * @param cli
+ * @param status - one of CLI_FRAME_STATUS_*
+ */
+static void finishFrameResponse(EmbeddedCli *cli, uint8_t status);
+
+/**
+ * Used as writeChar while response is written
+ * @param cli
+ * @param c
+ */
+static void writeFramedOutput(EmbeddedCli *cli, char c);
+
+/**
+ * Add byte to response and to its CRC
+ * @param cli
+ * @param b
+ */
+static void writeFrameByte(EmbeddedCli *cli, uint8_t b);
+
+/**
+ * COBS encode single byte of response
+ * @param cli
+ * @param b
+ */
+static void encodeFrameByte(EmbeddedCli *cli, uint8_t b);
+
+/**
+ * Write encoded block of response with given code
+ * @param cli
+ * @param code - COBS code of block
+ */
+static void flushFrameBlock(EmbeddedCli *cli, uint8_t code);
+
+/**
+ * Add byte to CRC-16/CCITT-FALSE
+ * @param crc - current value
+ * @param b
+ * @return updated value
+ */
+static uint16_t updateFrameCrc(uint16_t crc, uint8_t b);
+
+/**
+ * Used as writeChar when output of executed command is discarded
+ * @param cli
+ * @param c
+ */
+static void writeNothing(EmbeddedCli *cli, char c);
+
+/**
+ * Show help for given tokens (or default help if no tokens)
+ * @param cli
+ * @param tokens
+ * @param context - not used
+ */
+static void onHelp(EmbeddedCli *cli, char *tokens, void *context);
+
+/**
+ * Show call statistics for all bindings (or for given binding)
+ * @param cli
+ * @param tokens
+ * @param context - not used
+ */
+static void onStats(EmbeddedCli *cli, char *tokens, void *context);
+
+/**
+ * Start periodic execution of command given in args
+ * @param cli
+ * @param args - period, command and its args (not tokenized)
+ * @param context - not used
+ */
+static void onWatch(EmbeddedCli *cli, char *args, void *context);
+
+/**
+ * Terminate word at the beginning of watch args
+ * @param arg - beginning of word
+ * @return beginning of next word or NULL if there are no more words
+ */
+static char *splitWatchArg(char *arg);
+
+/**
+ * Execute all watched commands which deadline is reached. After last watch
+ * is cancelled, invitation and current command are printed again
+ * @param cli
+ */
+static void processWatches(EmbeddedCli *cli);
+
+/**
+ * Find the earliest deadline of active watches
+ * @param cli
+ * @param deadline - where deadline is stored
+ * @return false if there are no active watches (or getTime is not set)
+ */
+static bool getNextWatchDeadline(EmbeddedCli *cli, uint32_t *deadline);
+
+/**
+ * Execute single watched command and redraw its output in place
+ * @param cli
+ * @param watch - index of watch
+ */
+static void runWatch(EmbeddedCli *cli, uint16_t watch);
+
+/**
+ * Cancel all active watches. Their output is left on the screen
+ * @param cli
+ */
+static void cancelWatches(EmbeddedCli *cli);
+
+/**
+ * Used as writeChar while watched command is executed. Counts printed lines
+ * and clears remains of previous output at the end of each line
+ * @param cli
+ * @param c
+ */
+static void writeWatchOutput(EmbeddedCli *cli, char c);
+
+/**
+ * Move cursor by given amount of lines up ('A') or down ('B')
+ * @param cli
+ * @param lines
+ * @param direction
+ */
+static void moveCursor(EmbeddedCli *cli, uint16_t lines, char direction);
+
+/**
+ * Print statistics of binding at given index
+ * @param cli
+ * @param binding
+ */
+static void printBindingStats(EmbeddedCli *cli, uint16_t binding);
+
+/**
+ * Print name and help of binding at given index
+ * @param cli
+ * @param binding
+ */
+static void printBindingHelp(EmbeddedCli *cli, uint16_t binding);
+
+/**
+ * Write help string to output. Compressed string is expanded with help
+ * dictionary
+ * @param cli
+ * @param help
+ */
+static void writeHelp(EmbeddedCli *cli, const char *help);
+
+/**
+ * Check whether output of current command can be generated incrementally
+ * @param cli
+ * @return true if command was typed by user and generator is enabled
+ */
+static bool canGenerateOutput(EmbeddedCli *cli);
+
+/**
+ * Start incremental output of given type. Output is written from
+ * embeddedCliProcess
+ * @param cli
+ * @param type - one of CLI_GENERATOR_*
+ */
+static void startGenerator(EmbeddedCli *cli, uint8_t type);
+
+/**
+ * Write next chunk of generated output. When output is finished, invitation
+ * is printed again
+ * @param cli
+ */
+static void runGenerator(EmbeddedCli *cli);
+
+/**
+ * Stop generated output and print invitation on new line
+ * @param cli
+ */
+static void cancelGenerator(EmbeddedCli *cli);
+
+/**
+ * Used as writeChar while output is generated. Skips chars that were written
+ * by previous calls and drops chars that don't fit into budget
+ * @param cli
+ * @param c
+ */
+static void writeGeneratedOutput(EmbeddedCli *cli, char c);
+
+/**
+ * Show error about unknown command
+ * @param cli
+ * @param name
+ */
+static void onUnknownCommand(EmbeddedCli *cli, const char *name);
+
+/**
+ * Return autocompleted command for given prefix.
+ * Prefix is compared to all known command bindings and autocompleted result
+ * is returned
+ * @param cli
+ * @param prefix
+ * @return
+ */
+static AutocompletedCommand getAutocompletedCommand(EmbeddedCli *cli, const char *prefix);
+
+/**
+ * Unset autocomplete flag for all candidates found by last call to
+ * getAutocompletedCommand
+ * @param cli
+ */
+static void resetAutocompleteCandidates(EmbeddedCli *cli);
+
+/**
+ * Prints autocompletion result while keeping current command unchanged
+ * Prints only if autocompletion is present and only one candidate exists.
+ * @param cli
+ */
+static void printLiveAutocompletion(EmbeddedCli *cli);
+
+/**
+ * Handles autocomplete request. If autocomplete possible - fills current
+ * command with autocompleted command. When multiple commands satisfy entered
+ * prefix, they are printed to output.
+ * @param cli
+ */
+static void onAutocompleteRequest(EmbeddedCli *cli);
+
+/**
+ * Removes all input from current line (replaces it with whitespaces)
+ * And places cursor at the beginning of the line
+ * @param cli
+ */
+static void clearCurrentLine(EmbeddedCli *cli);
+
+/**
+ * Write given string to cli output
+ * @param cli
+ * @param str
+ */
+static void writeToOutput(EmbeddedCli *cli, const char *str);
+
+/**
+ * Write given unsigned number in decimal form to cli output
+ * @param cli
+ * @param value
+ */
+static void writeNumber(EmbeddedCli *cli, uint32_t value);
+
+/**
+ * Returns true if provided char is a supported control char:
+ * \r, \n, \b or 0x7F (treated as \b)
+ * @param c
+ * @return
+ */
+static bool isControlChar(char c);
+
+/**
+ * Returns true if provided char is a valid displayable character:
+ * a-z, A-Z, 0-9, whitespace, punctuation, etc.
+ * Currently only ASCII is supported
+ * @param c
+ * @return
+ */
+static bool isDisplayableChar(char c);
+
+/**
+ * Returns type of received char as one of CLI_INPUT_READY_* flags (or 0 if
+ * char is inside of escape sequence and doesn't need processing yet).
+ * Updates state of escape sequence in received chars.
+ * @param impl
+ * @param c
+ * @return
+ */
+static uint8_t getInputReadyTrigger(EmbeddedCliImpl *impl, char c);
+
+/**
+ * How many elements are currently available in buffer
+ * @param buffer
+ * @return number of elements
+ */
+static uint16_t fifoBufAvailable(FifoBuf *buffer);
+
+/**
+ * Return first character from buffer and remove it from buffer
+ * Buffer must be non-empty, otherwise 0 is returned
+ * @param buffer
+ * @return
+ */
+static char fifoBufPop(FifoBuf *buffer);
+
+/**
+ * Push character into fifo buffer. If there is no space left, character is
+ * discarded and false is returned
+ * @param buffer
+ * @param a - character to add
+ * @return true if char was added to buffer, false otherwise
+ */
+static bool fifoBufPush(FifoBuf *buffer, char a);
+
+/**
+ * Copy provided string to the history buffer.
+ * If it is already inside history, it will be removed from it and added again.
+ * So after addition, it will always be on top
+ * If available size is not enough (and total size is enough) old elements will
+ * be removed from history so this item can be put to it
+ * @param history
+ * @param str
+ * @return true if string was put in history
+ */
+static bool historyPut(CliHistory *history, const char *str);
+
+/**
+ * Get item from history. Items are counted from 1 so if item is 0 or greater
+ * than itemCount, NULL is returned
+ * @param history
+ * @param item
+ * @return true if string was put in history
+ */
+static const char *historyGet(CliHistory *history, uint16_t item);
+
+/**
+ * Remove specific item from history
+ * @param history
+ * @param str - string to remove
+ * @return
+ */
+static void historyRemove(CliHistory *history, const char *str);
+
+/**
+ * Return number of bytes used by history items (including their null chars)
+ * @param history
+ * @return
+ */
+static uint16_t historyUsedSize(CliHistory *history);
+
+/**
+ * Return length of string (same as strlen, but scans whole words)
+ * @param str
+ * @return
+ */
+static size_t cliStrLen(const char *str);
+
+/**
+ * Returns true if first len chars of both strings are equal. Strings are
+ * compared by whole words when they have the same alignment.
+ * @param a
+ * @param b
+ * @param len
+ * @return
+ */
+static bool cliMemEqual(const char *a, const char *b, size_t len);
+
+/**
+ * Write 16bit value in little endian order
+ * @param buf
+ * @param value
+ */
+static void writeU16(uint8_t *buf, uint16_t value);
+
+/**
+ * Read 16bit value in little endian order
+ * @param buf
+ * @return
+ */
+static uint16_t readU16(const uint8_t *buf);
+
+/**
+ * Calculate Fletcher-16 checksum of given data
+ * @param data
+ * @param len
+ * @return
+ */
+static uint16_t stateChecksum(const uint8_t *data, size_t len);
+
+/**
+ * Return position (index of first char) of specified token
+ * @param tokenizedStr - tokenized string (separated by \0 with
+ * \0\0 at the end)
+ * @param pos - token position (counted from 1)
+ * @return index of first char of specified token
+ */
+static uint16_t getTokenPosition(const char *tokenizedStr, uint16_t pos);
+
+/**
+ * Returns how many radix tree nodes are required for given amount of
+ * bindings. Each binding adds at most one leaf and one branching node.
+ * @param bindingCount
+ * @return
+ */
+static uint16_t radixTreeNodesCount(uint16_t bindingCount);
+
+/**
+ * Returns true if some binding name ends at given node
+ * @param tree
+ * @param node
+ * @return
+ */
+static bool radixNodeIsTerminal(CliRadixTree *tree, uint16_t node);
+
+/**
+ * Returns child of given node which label starts with specified char
+ * @param tree
+ * @param node
+ * @param c - first char of label
+ * @return child index or CLI_RADIX_NONE if there is no such child
+ */
+static uint16_t radixNodeFindChild(CliRadixTree *tree, uint16_t node, char c);
+
+/**
+ * Add child to the list of node children
+ * @param tree
+ * @param node
+ * @param child
+ */
+static void radixNodeAddChild(CliRadixTree *tree, uint16_t node, uint16_t child);
+
+/**
+ * Put replacement node in place of given node inside list of parent children.
+ * @param tree
+ * @param node
+ * @param replacement - node to put instead or CLI_RADIX_NONE to just remove
+ * node from the list
+ */
+static void radixNodeReplace(CliRadixTree *tree, uint16_t node, uint16_t replacement);
+
+/**
+ * Take unused node (reusing removed ones first)
+ * @param tree
+ * @return node index or CLI_RADIX_NONE if there are no unused nodes
+ */
+static uint16_t radixNodeAlloc(CliRadixTree *tree);
+
+/**
+ * Return node to the list of removed nodes
+ * @param tree
+ * @param node
+ */
+static void radixNodeFree(CliRadixTree *tree, uint16_t node);
+
+/**
+ * Follow given string from root as far as possible.
+ * @param tree
+ * @param str
+ * @param len - length of string (it doesn't have to be null-terminated)
+ * @param isPrefix - if true, string is allowed to end in the middle of label
+ * @return node where string ends or CLI_RADIX_NONE if string is not in tree
+ */
+static uint16_t radixTreeFindNode(CliRadixTree *tree, const char *str, uint16_t len, bool isPrefix);
+
+/**
+ * Reset tree so it contains only root node
+ * @param tree
+ */
+static void radixTreeReset(CliRadixTree *tree);
+
+/**
+ * Add name of specified binding to the tree.
+ * Binding name must not be empty and must not be already present in tree.
+ * @param tree
+ * @param binding - index of binding
+ * @return true if name was added to the tree
+ */
+static bool radixTreeInsert(CliRadixTree *tree, uint16_t binding);
+
+/**
+ * Find binding with exactly given name
+ * @param tree
+ * @param name
+ * @param len - length of name (name doesn't have to be null-terminated)
+ * @return index of binding or CLI_RADIX_NONE if nothing found
+ */
+static uint16_t radixTreeFind(CliRadixTree *tree, const char *name, uint16_t len);
+
+/**
+ * Remove name of specified binding from the tree. Tree is kept compressed,
+ * so only nodes on the path of the name are changed.
+ * Binding name must be present in tree.
+ * @param tree
+ * @param binding - index of binding
+ */
+static void radixTreeRemove(CliRadixTree *tree, uint16_t binding);
+
+/**
+ * Find root of subtree with all bindings which names start with given prefix.
+ * Returned node is the deepest node that is common to all these bindings, so
+ * its depth is the length of their common prefix.
+ * @param tree
+ * @param prefix
+ * @return node index or CLI_RADIX_NONE if no binding starts with prefix
+ */
+static uint16_t radixTreeFindPrefix(CliRadixTree *tree, const char *prefix);
+
+/**
+ * Iterate over terminal nodes (that have binding name ending at them)
+ * inside given subtree.
+ * @param tree
+ * @param subtree - root of subtree to iterate
+ * @param node - previous returned node or CLI_RADIX_NONE to start iteration
+ * @return next terminal node or CLI_RADIX_NONE when iteration is finished
+ */
+static uint16_t radixTreeNextTerminal(CliRadixTree *tree, uint16_t subtree, uint16_t node);
+
+EmbeddedCliConfig *embeddedCliDefaultConfig(void) {
+    embeddedCliInitDefaultConfig(&defaultConfig);
+    return &defaultConfig;
+}
+
+void embeddedCliInitDefaultConfig(EmbeddedCliConfig *config) {
+    config->rxBufferSize = 64;
+    config->cmdBufferSize = 64;
+    config->historyBufferSize = 128;
+    config->cliBuffer = NULL;
+    config->cliBufferSize = 0;
+    config->maxBindingCount = 8;
+    config->maxWatchCount = 0;
+    config->ticksPerMs = 1;
+    config->filterBufferSize = 0;
+    config->outputChunkSize = 0;
+    config->frameBufferSize = 0;
+    config->helpDictionary = NULL;
+    config->inputReadyTriggers = CLI_INPUT_READY_ALL;
+    config->lock = NULL;
+    config->unlock = NULL;
+    config->enableAutoComplete = true;
+    config->enableBindingStats = false;
+    config->enableChaining = false;
+    config->enableExecute = false;
+    config->invitation = "> ";
+}
+
+uint16_t embeddedCliRequiredSize(const EmbeddedCliConfig *config) {
+    size_t size = getRequiredSize(config);
+    return size > UINT16_MAX ? 0 : (uint16_t) size;
+}
+
+static size_t getRequiredSize(const EmbeddedCliConfig *config) {
+    size_t bindingCount = (size_t) config->maxBindingCount + getInternalBindingCount(config);
+    size_t statsCount = config->enableBindingStats ? bindingCount : 0;
+    size_t execSize = hasExecBuffer(config) ? config->cmdBufferSize : 0;
+    // same as radixTreeNodesCount, but without truncation
+    size_t nodesCount = 2 * bindingCount + 1;
+    return CLI_UINT_SIZE * (
+            BYTES_TO_CLI_UINTS(sizeof(EmbeddedCli)) +
+            BYTES_TO_CLI_UINTS(sizeof(EmbeddedCliImpl)) +
+            BYTES_TO_CLI_UINTS(config->rxBufferSize * sizeof(char)) +
+            BYTES_TO_CLI_UINTS(config->cmdBufferSize * sizeof(char)) +
+            BYTES_TO_CLI_UINTS(execSize * sizeof(char)) +
+            BYTES_TO_CLI_UINTS(config->historyBufferSize * sizeof(char)) +
+            BYTES_TO_CLI_UINTS(bindingCount * sizeof(CliCommandBinding)) +
+            BYTES_TO_CLI_UINTS(bindingCount * sizeof(uint8_t)) +
+            BYTES_TO_CLI_UINTS(bindingCount * sizeof(uint16_t)) +
+            BYTES_TO_CLI_UINTS(statsCount * sizeof(CliBindingStats)) +
+            BYTES_TO_CLI_UINTS(nodesCount * sizeof(CliRadixNode)) +
+            BYTES_TO_CLI_UINTS(config->maxWatchCount * sizeof(CliWatch)) +
+            config->maxWatchCount * BYTES_TO_CLI_UINTS(config->cmdBufferSize * sizeof(char)) +
+            BYTES_TO_CLI_UINTS(config->filterBufferSize * sizeof(char)) +
+            (config->frameBufferSize > 0 ? BYTES_TO_CLI_UINTS(config->frameBufferSize + CLI_FRAME_BLOCK_SIZE) : 0));
+}
+
+EmbeddedCli *embeddedCliNew(const EmbeddedCliConfig *config) {
+    EmbeddedCli *cli = NULL;
+
+    // buffer sizes and offsets inside of cli are 16 bit
+    size_t totalSize = getRequiredSize(config);
+    if (totalSize > UINT16_MAX)
+        return NULL;
+
+    uint16_t bindingCount = (uint16_t) (config->maxBindingCount + getInternalBindingCount(config));
+
+    // config is never modified, so it can be shared between instances
+    CLI_UINT *buf = config->cliBuffer;
+    bool allocated = false;
+    if (buf == NULL) {
+        buf = (CLI_UINT *) malloc(totalSize); // malloc guarantees alignment.
+        if (buf == NULL)
+            return NULL;
+        allocated = true;
+    } else if (config->cliBufferSize < totalSize) {
+        return NULL;
+    }
+
+    memset(buf, 0, totalSize);
+
+    cli = (EmbeddedCli *) buf;
+    buf += BYTES_TO_CLI_UINTS(sizeof(EmbeddedCli));
+
+    cli->_impl = (EmbeddedCliImpl *) buf;
+    buf += BYTES_TO_CLI_UINTS(sizeof(EmbeddedCliImpl));
+
+    PREPARE_IMPL(cli);
+    impl->rxBuffer.buf = (char *) buf;
+    buf += BYTES_TO_CLI_UINTS(config->rxBufferSize * sizeof(char));
+
+    impl->cmdBuffer = (char *) buf;
+    buf += BYTES_TO_CLI_UINTS(config->cmdBufferSize * sizeof(char));
+
+    if (hasExecBuffer(config)) {
+        impl->execBuffer = (char *) buf;
+        buf += BYTES_TO_CLI_UINTS(config->cmdBufferSize * sizeof(char));
+    }
+    impl->executeEnabled = config->enableExecute;
+
+    impl->bindings = (CliCommandBinding *) buf;
+    buf += BYTES_TO_CLI_UINTS(bindingCount * sizeof(CliCommandBinding));
+
+    impl->bindingsFlags = (uint8_t *) buf;
+    buf += BYTES_TO_CLI_UINTS(bindingCount);
+
+    impl->nextFreeBindings = (uint16_t *) buf;
+    buf += BYTES_TO_CLI_UINTS(bindingCount * sizeof(uint16_t));
+
+    if (config->enableBindingStats) {
+        impl->bindingsStats = (CliBindingStats *) buf;
+        buf += BYTES_TO_CLI_UINTS(bindingCount * sizeof(CliBindingStats));
+    }
+
+    impl->bindingsTree.nodes = (CliRadixNode *) buf;
+    impl->bindingsTree.maxNodesCount = radixTreeNodesCount(bindingCount);
+    buf += BYTES_TO_CLI_UINTS(impl->bindingsTree.maxNodesCount * sizeof(CliRadixNode));
+
+    impl->watches = (CliWatch *) buf;
+    buf += BYTES_TO_CLI_UINTS(config->maxWatchCount * sizeof(CliWatch));
+    for (uint16_t i = 0; i < config->maxWatchCount; ++i) {
+        impl->watches[i].args = (char *) buf;
+        impl->watches[i].binding = CLI_RADIX_NONE;
+        buf += BYTES_TO_CLI_UINTS(config->cmdBufferSize * sizeof(char));
+    }
+
+    if (config->filterBufferSize > 0) {
+        impl->filterBuffer = (char *) buf;
+        buf += BYTES_TO_CLI_UINTS(config->filterBufferSize * sizeof(char));
+    }
+
+    if (config->frameBufferSize > 0) {
+        impl->frameBuffer = (uint8_t *) buf;
+        impl->frameBlock = impl->frameBuffer + config->frameBufferSize;
+        buf += BYTES_TO_CLI_UINTS(config->frameBufferSize + CLI_FRAME_BLOCK_SIZE);
+    }
+
+    impl->history.buf = (char *) buf;
+    impl->history.bufferSize = config->historyBufferSize;
+
+    if (allocated)
+        SET_FLAG(impl->flags, CLI_FLAG_ALLOCATED);
+
+    if (config->enableAutoComplete)
+        SET_FLAG(impl->flags, CLI_FLAG_AUTOCOMPLETE_ENABLED);
+
+    if (config->enableChaining)
+        SET_FLAG(impl->flags, CLI_FLAG_CHAINING_ENABLED);
+
+    impl->rxBuffer.size = config->rxBufferSize;
+    impl->rxBuffer.front = 0;
+    impl->rxBuffer.back = 0;
+    impl->cmdMaxSize = config->cmdBufferSize;
+    impl->bindingsCount = 0;
+    impl->bindingSlotsCount = 0;
+    impl->freeBindings = CLI_RADIX_NONE;
+    impl->maxBindingsCount = bindingCount;
+    impl->lastChar = '\0';
+    impl->invitation = config->invitation;
+    impl->bindingsTree.bindings = impl->bindings;
+    impl->candidatesRoot = CLI_RADIX_NONE;
+    impl->maxWatchesCount = config->maxWatchCount;
+    impl->ticksPerMs = config->ticksPerMs != 0 ? config->ticksPerMs : 1;
+    impl->filterBufferSize = config->filterBufferSize;
+    impl->outputChunkSize = config->outputChunkSize;
+    impl->frameBufferSize = config->frameBufferSize;
+    impl->helpDictionary = config->helpDictionary;
+    impl->generator.type = CLI_GENERATOR_NONE;
+    impl->inputReadyTriggers = config->inputReadyTriggers;
+    impl->telnetReplies.buf = impl->telnetRepliesBuf;
+    impl->telnetReplies.size = CLI_TELNET_REPLIES_SIZE;
+    impl->lock = config->lock;
+    impl->unlock = config->unlock;
+    radixTreeReset(&impl->bindingsTree);
+
+    initInternalBindings(cli);
+
+    return cli;
+}
+
+EmbeddedCli *embeddedCliNewDefault(void) {
+    EmbeddedCliConfig config;
+    embeddedCliInitDefaultConfig(&config);
+    return embeddedCliNew(&config);
+}
+
+void embeddedCliReceiveChar(EmbeddedCli *cli, char c) {
+    PREPARE_IMPL(cli);
+
+    uint8_t trigger = getInputReadyTrigger(impl, c);
+
+    if (!fifoBufPush(&impl->rxBuffer, c)) {
+        SET_FLAG(impl->flags, CLI_FLAG_OVERFLOW);
+        // overflow must be processed as soon as possible
+        trigger = CLI_INPUT_READY_ALL;
+    }
+
+    if (cli->onInputReady != NULL && (impl->inputReadyTriggers & trigger) != 0)
+        cli->onInputReady(cli);
+}
+
+bool embeddedCliProcess(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    // lock is released while bindings are called
+    lockCli(cli);
+    if (cli->writeChar == NULL) {
+        unlockCli(cli);
+        return false;
+    }
+    // binding is executed from other thread, input is processed after it
+    // (onInputReady is called when it finishes)
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_EXECUTING)) {
+        SET_FLAG(impl->flags, CLI_FLAG_INPUT_DEFERRED);
+        unlockCli(cli);
+        return false;
+    }
+
+    if (!IS_FLAG_SET(impl->flags, CLI_FLAG_INIT_COMPLETE | CLI_FLAG_FRAMED)) {
+        SET_FLAG(impl->flags, CLI_FLAG_INIT_COMPLETE);
+        writeToOutput(cli, impl->invitation);
+    }
+
+    while (fifoBufAvailable(&impl->telnetReplies) >= 2) {
+        uint8_t command = (uint8_t) fifoBufPop(&impl->telnetReplies);
+        writeTelnetCommand(cli, command, (uint8_t) fifoBufPop(&impl->telnetReplies));
+    }
+
+    while (fifoBufAvailable(&impl->rxBuffer)) {
+        processInputChar(cli, fifoBufPop(&impl->rxBuffer));
+
+        // lock is released between chars, so other tasks can print. They
+        // can also start a command, then rest of input waits for next call
+        unlockCli(cli);
+        lockCli(cli);
+        if (IS_FLAG_SET(impl->flags, CLI_FLAG_EXECUTING)) {
+            SET_FLAG(impl->flags, CLI_FLAG_INPUT_DEFERRED);
+            unlockCli(cli);
+            return false;
+        }
+    }
+    // input that was left by other calls is processed now
+    UNSET_U16FLAG(impl->flags, CLI_FLAG_INPUT_DEFERRED);
+
+    // discard unfinished command if overflow happened
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_OVERFLOW)) {
+        impl->cmdSize = 0;
+        impl->cmdBuffer[impl->cmdSize] = '\0';
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_OVERFLOW);
+    }
+
+    processWatches(cli);
+
+    if (impl->generator.type != CLI_GENERATOR_NONE)
+        runGenerator(cli);
+
+    // chars could be received while bindings were executed. Watches are
+    // pending only when they are late, otherwise host waits for next deadline
+    uint32_t deadline = 0;
+    bool pending = fifoBufAvailable(&impl->rxBuffer) > 0 || impl->generator.type != CLI_GENERATOR_NONE ||
+                   (getNextWatchDeadline(cli, &deadline) && cli->getTime(cli) - deadline < 0x80000000u);
+    unlockCli(cli);
+    return pending;
+}
+
+bool embeddedCliGetNextWatchTime(EmbeddedCli *cli, uint32_t *time) {
+    if (time == NULL)
+        return false;
+
+    lockCli(cli);
+    bool active = getNextWatchDeadline(cli, time);
+    unlockCli(cli);
+    return active;
+}
+
+bool embeddedCliAddBinding(EmbeddedCli *cli, CliCommandBinding binding) {
+    lockCli(cli);
+    bool added = addBinding(cli, binding);
+    unlockCli(cli);
+    return added;
+}
+
+bool embeddedCliRemoveBinding(EmbeddedCli *cli, const char *name) {
+    lockCli(cli);
+    bool removed = removeBinding(cli, name);
+    unlockCli(cli);
+    return removed;
+}
+
+bool embeddedCliReplaceBinding(EmbeddedCli *cli, CliCommandBinding binding) {
+    PREPARE_IMPL(cli);
+    if (binding.name == NULL)
+        return false;
+
+    lockCli(cli);
+    uint16_t i = radixTreeFind(&impl->bindingsTree, binding.name, (uint16_t) cliStrLen(binding.name));
+    // name is the same, so tree doesn't change
+    if (i != CLI_RADIX_NONE) {
+        impl->bindings[i] = binding;
+        UNSET_U8FLAG(impl->bindingsFlags[i], BINDING_FLAG_INTERNAL);
+    }
+    unlockCli(cli);
+
+    return i != CLI_RADIX_NONE;
+}
+
+bool embeddedCliExecute(EmbeddedCli *cli, const char *line, uint8_t flags) {
+    lockCli(cli);
+    bool success = executeLine(cli, line, flags);
+    bool notify = takeDeferredInput(cli);
+    unlockCli(cli);
+    if (notify)
+        cli->onInputReady(cli);
+    return success;
+}
+
+bool embeddedCliReceiveLine(EmbeddedCli *cli, const char *line, size_t len, bool echo) {
+    PREPARE_IMPL(cli);
+    while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == '\n'))
+        --len;
+
+    lockCli(cli);
+    // lines are not accepted in framed mode and while bindings are executed
+    if (cli->writeChar == NULL || IS_FLAG_SET(impl->flags, CLI_FLAG_FRAMED | CLI_FLAG_EXECUTING)) {
+        unlockCli(cli);
+        return false;
+    }
+    if (!IS_FLAG_SET(impl->flags, CLI_FLAG_INIT_COMPLETE)) {
+        SET_FLAG(impl->flags, CLI_FLAG_INIT_COMPLETE);
+        writeToOutput(cli, impl->invitation);
+    }
+    // new line cancels output the same way as typed key
+    cancelWatches(cli);
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_WATCH_SCREEN)) {
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_WATCH_SCREEN);
+        writeToOutput(cli, impl->invitation);
+    }
+    if (impl->generator.type != CLI_GENERATOR_NONE)
+        cancelGenerator(cli);
+
+    // have to reserve two extra chars for command ending (same as typed input)
+    if (len + 2 > impl->cmdMaxSize) {
+        unlockCli(cli);
+        return false;
+    }
+
+    if (echo) {
+        // remove chars typed before line was received
+        if (impl->inputLineLength > 0 || impl->cmdSize > 0) {
+            clearCurrentLine(cli);
+            writeToOutput(cli, impl->invitation);
+        }
+        for (size_t i = 0; i < len; ++i)
+            cli->writeChar(cli, line[i]);
+        writeToOutput(cli, lineBreak);
+    }
+
+    memcpy(impl->cmdBuffer, line, len);
+    impl->cmdBuffer[len] = '\0';
+    impl->cmdSize = (uint16_t) len;
+
+    if (impl->outputChunkSize > 0)
+        SET_FLAG(impl->flags, CLI_FLAG_INTERACTIVE);
+    SET_FLAG(impl->flags, CLI_FLAG_EXECUTING);
+    bool success = parseCommand(getCommandCli(cli), impl->cmdBuffer, impl->cmdSize, true);
+    UNSET_U16FLAG(impl->flags, CLI_FLAG_INTERACTIVE | CLI_FLAG_EXECUTING);
+
+    impl->cmdSize = 0;
+    impl->cmdBuffer[impl->cmdSize] = '\0';
+    impl->inputLineLength = 0;
+    impl->history.current = 0;
+
+    if (impl->generator.type == CLI_GENERATOR_NONE && !IS_FLAG_SET(impl->flags, CLI_FLAG_FRAMED))
+        writeToOutput(cli, impl->invitation);
+    bool notify = takeDeferredInput(cli);
+    unlockCli(cli);
+    if (notify)
+        cli->onInputReady(cli);
+    return success;
+}
+
+CliScriptResult embeddedCliRunScript(EmbeddedCli *cli, const char *script, size_t len,
+                                     const CliScriptOptions *options) {
+    lockCli(cli);
+    CliScriptResult result = runScript(cli, script, len, options);
+    bool notify = takeDeferredInput(cli);
+    unlockCli(cli);
+    if (notify)
+        cli->onInputReady(cli);
+    return result;
+}
+
+void embeddedCliCommandFailed(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    lockCli(cli);
+    SET_FLAG(impl->flags, CLI_FLAG_COMMAND_FAILED);
+    unlockCli(cli);
+}
+
+bool embeddedCliGetBindingStats(EmbeddedCli *cli, const char *name, CliBindingStats *stats) {
+    PREPARE_IMPL(cli);
+    if (impl->bindingsStats == NULL || name == NULL || stats == NULL)
+        return false;
+
+    // stats are copied under lock, since they are updated by each call
+    lockCli(cli);
+    uint16_t i = radixTreeFind(&impl->bindingsTree, name, (uint16_t) cliStrLen(name));
+    if (i != CLI_RADIX_NONE)
+        *stats = impl->bindingsStats[i];
+    unlockCli(cli);
+
+    return i != CLI_RADIX_NONE;
+}
+
+void embeddedCliResetBindingStats(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    if (impl->bindingsStats == NULL)
+        return;
+
+    lockCli(cli);
+    memset(impl->bindingsStats, 0, impl->maxBindingsCount * sizeof(CliBindingStats));
+    unlockCli(cli);
+}
+
+void embeddedCliPrint(EmbeddedCli *cli, const char *string) {
+    PREPARE_IMPL(cli);
+    // output is written under lock, otherwise it could be mixed with redraw
+    // of current command
+    lockCli(cli);
+    if (cli->writeChar == NULL) {
+        unlockCli(cli);
+        return;
+    }
+
+    // there is no invitation in framed mode. Bindings print to response,
+    // messages of other tasks are sent in separate frames but only between
+    // responses, otherwise they would be mixed with partially written one
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_FRAMED) && cli != &impl->commandCli) {
+        if (!IS_FLAG_SET(impl->flags, CLI_FLAG_EXECUTING)) {
+            EmbeddedCli *command = getCommandCli(cli);
+            startFrameResponse(command, CLI_BINDING_ID_NONE);
+            writeToOutput(command, string);
+            finishFrameResponse(command, CLI_FRAME_STATUS_MESSAGE);
+        }
+        unlockCli(cli);
+        return;
+    }
+
+    // invitation is not on the screen while output is generated or command
+    // prints directly (unless output is discarded and this is other task)
+    bool direct = IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT) &&
+                  (cli == &impl->commandCli || !IS_FLAG_SET(impl->flags, CLI_FLAG_HIDDEN_OUTPUT));
+    bool redraw = !direct && impl->generator.type == CLI_GENERATOR_NONE;
+
+    // remove chars for autocompletion and live command
+    if (redraw)
+        clearCurrentLine(cli);
+
+    // print provided string
+    writeToOutput(cli, string);
+    writeToOutput(cli, lineBreak);
+
+    // print current command back to screen
+    if (redraw) {
+        writeToOutput(cli, impl->invitation);
+        writeToOutput(cli, impl->cmdBuffer);
+        impl->inputLineLength = impl->cmdSize;
+
+        printLiveAutocompletion(cli);
+    }
+    unlockCli(cli);
+}
+
+bool embeddedCliSetFramedMode(EmbeddedCli *cli, bool enabled) {
+    PREPARE_IMPL(cli);
+    if (impl->frameBuffer == NULL)
+        return false;
+
+    lockCli(cli);
+    if (enabled && !IS_FLAG_SET(impl->flags, CLI_FLAG_FRAMED)) {
+        // output of watches and help can't be mixed with frames
+        cancelWatches(cli);
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_WATCH_SCREEN);
+        impl->generator.type = CLI_GENERATOR_NONE;
+        impl->frameSize = 0;
+        impl->frameCode = 0;
+        impl->frameLeft = 0;
+        SET_FLAG(impl->flags, CLI_FLAG_FRAMED | CLI_FLAG_FRAME_SYNC);
+    } else if (!enabled && IS_FLAG_SET(impl->flags, CLI_FLAG_FRAMED)) {
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_FRAMED);
+        // invitation is printed by next call to process
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_INIT_COMPLETE);
+        impl->lastChar = '\0';
+    }
+    unlockCli(cli);
+    return true;
+}
+
+uint16_t embeddedCliGetBindingId(EmbeddedCli *cli, const char *name) {
+    PREPARE_IMPL(cli);
+    if (name == NULL)
+        return CLI_BINDING_ID_NONE;
+
+    lockCli(cli);
+    uint16_t i = radixTreeFind(&impl->bindingsTree, name, (uint16_t) cliStrLen(name));
+    unlockCli(cli);
+    return i != CLI_RADIX_NONE ? i : CLI_BINDING_ID_NONE;
+}
+
+size_t embeddedCliGetStateSize(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    lockCli(cli);
+    size_t size = CLI_STATE_HEADER_SIZE + impl->cmdSize + historyUsedSize(&impl->history) +
+                  CLI_STATE_CHECKSUM_SIZE;
+    unlockCli(cli);
+    return size;
+}
+
+size_t embeddedCliSaveState(EmbeddedCli *cli, void *buffer, size_t size) {
+    PREPARE_IMPL(cli);
+    lockCli(cli);
+
+    uint16_t historySize = historyUsedSize(&impl->history);
+    size_t total = CLI_STATE_HEADER_SIZE + impl->cmdSize + historySize + CLI_STATE_CHECKSUM_SIZE;
+    if (buffer == NULL || size < total) {
+        unlockCli(cli);
+        return 0;
+    }
+
+    uint8_t *state = (uint8_t *) buffer;
+    state[0] = CLI_STATE_MAGIC;
+    state[1] = CLI_STATE_VERSION;
+    state[2] = IS_FLAG_SET(impl->flags, CLI_FLAG_INIT_COMPLETE) ? CLI_STATE_FLAG_INIT_COMPLETE : 0;
+    state[3] = (uint8_t) impl->lastChar;
+    writeU16(&state[4], impl->cmdSize);
+    writeU16(&state[6], impl->inputLineLength);
+    writeU16(&state[8], impl->history.itemsCount);
+    writeU16(&state[10], historySize);
+    memcpy(&state[CLI_STATE_HEADER_SIZE], impl->cmdBuffer, impl->cmdSize);
+    memcpy(&state[CLI_STATE_HEADER_SIZE + impl->cmdSize], impl->history.buf, historySize);
+    writeU16(&state[total - CLI_STATE_CHECKSUM_SIZE], stateChecksum(state, total - CLI_STATE_CHECKSUM_SIZE));
+
+    unlockCli(cli);
+    return total;
+}
+
+bool embeddedCliRestoreState(EmbeddedCli *cli, const void *buffer, size_t size) {
+    if (buffer == NULL || size < CLI_STATE_HEADER_SIZE + CLI_STATE_CHECKSUM_SIZE)
+        return false;
+
+    const uint8_t *state = (const uint8_t *) buffer;
+    uint16_t cmdSize = readU16(&state[4]);
+    uint16_t itemsCount = readU16(&state[8]);
+    uint16_t historySize = readU16(&state[10]);
+    size_t total = CLI_STATE_HEADER_SIZE + cmdSize + historySize + CLI_STATE_CHECKSUM_SIZE;
+    if (state[0] != CLI_STATE_MAGIC || state[1] != CLI_STATE_VERSION || size < total ||
+        readU16(&state[total - CLI_STATE_CHECKSUM_SIZE]) != stateChecksum(state, total - CLI_STATE_CHECKSUM_SIZE))
+        return false;
+
+    // history must contain exactly itemsCount non-empty items
+    const char *history = (const char *) &state[CLI_STATE_HEADER_SIZE + cmdSize];
+    uint16_t nullCount = 0;
+    for (uint16_t i = 0; i < historySize; ++i) {
+        if (history[i] != '\0')
+            continue;
+        if (i == 0 || history[i - 1] == '\0')
+            return false;
+        ++nullCount;
+    }
+    if (nullCount != itemsCount || (historySize > 0 && history[historySize - 1] != '\0'))
+        return false;
+
+    PREPARE_IMPL(cli);
+    lockCli(cli);
+
+    // same as typed command, two extra chars are required for tokenization
+    if (cmdSize + 2 >= impl->cmdMaxSize) {
+        unlockCli(cli);
+        return false;
+    }
+
+    memcpy(impl->cmdBuffer, &state[CLI_STATE_HEADER_SIZE], cmdSize);
+    impl->cmdBuffer[cmdSize] = '\0';
+    impl->cmdSize = cmdSize;
+    impl->inputLineLength = readU16(&state[6]);
+    impl->lastChar = (char) state[3];
+    if ((state[2] & CLI_STATE_FLAG_INIT_COMPLETE) != 0)
+        SET_FLAG(impl->flags, CLI_FLAG_INIT_COMPLETE);
+    else
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_INIT_COMPLETE);
+
+    // items are put from the oldest one, so if history buffer is smaller
+    // than saved history, only the most recent items are kept
+    impl->history.itemsCount = 0;
+    impl->history.current = 0;
+    for (uint16_t i = itemsCount; i > 0; --i) {
+        // items that can't be typed into cmd buffer of this cli are skipped
+        const char *item = embeddedCliGetToken(history, i);
+        if (cliStrLen(item) + 2 < impl->cmdMaxSize)
+            historyPut(&impl->history, item);
+    }
+
+    unlockCli(cli);
+    return true;
+}
+
+void embeddedCliTelnetStart(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    lockCli(cli);
+
+    if (impl->telnetWriteChar == NULL) {
+        impl->telnetWriteChar = cli->writeChar;
+        cli->writeChar = writeTelnetOutput;
+    }
+    impl->telnetState = CLI_TELNET_DATA;
+    impl->telnetOptions = CLI_TELNET_ECHO | CLI_TELNET_SGA | CLI_TELNET_NAWS;
+    impl->windowWidth = 0;
+    writeTelnetCommand(cli, CLI_TELNET_WILL, CLI_TELNET_OPT_ECHO);
+    writeTelnetCommand(cli, CLI_TELNET_WILL, CLI_TELNET_OPT_SGA);
+    writeTelnetCommand(cli, CLI_TELNET_DO, CLI_TELNET_OPT_NAWS);
+
+    unlockCli(cli);
+}
+
+void embeddedCliTelnetReceive(EmbeddedCli *cli, const char *data, size_t size) {
+    PREPARE_IMPL(cli);
+
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t b = (uint8_t) data[i];
+        // most bytes are plain data, they go directly to rx buffer
+        if (impl->telnetState == CLI_TELNET_DATA && b != CLI_TELNET_IAC && b != '\r')
+            embeddedCliReceiveChar(cli, data[i]);
+        else
+            onTelnetInput(cli, b);
+    }
+}
+
+uint16_t embeddedCliGetWindowWidth(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    return impl->windowWidth;
+}
+
+void embeddedCliFree(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_ALLOCATED)) {
+        // allocation is done in single call to malloc, so need only single free
+        free(cli);
+    }
+}
+
+void embeddedCliTokenizeArgs(char *args) {
+    if (args == NULL)
+        return;
+
+    // for now only space, but can add more later
+    const char *separators = " ";
+
+    // indicates that arg is quoted so separators are copied as is
+    bool quotesEnabled = false;
+    // indicates that previous char was a slash, so next char is copied as is
+    bool escapeActivated = false;
+    int insertPos = 0;
+
+    int i = 0;
+    char currentChar;
+    while ((currentChar = args[i]) != '\0') {
+        ++i;
+
+        if (escapeActivated) {
+            escapeActivated = false;
+        } else if (currentChar == '\\') {
+            escapeActivated = true;
+            continue;
+        } else if (currentChar == '"') {
+            quotesEnabled = !quotesEnabled;
+            currentChar = '\0';
+        } else if (!quotesEnabled && strchr(separators, currentChar) != NULL) {
+            currentChar = '\0';
+        }
+
+        // null chars are only copied once and not copied to the beginning
+        if (currentChar != '\0' || (insertPos > 0 && args[insertPos - 1] != '\0')) {
+            args[insertPos] = currentChar;
+            ++insertPos;
+        }
+    }
+
+    // make args double null-terminated source buffer must be big enough to contain extra spaces
+    args[insertPos] = '\0';
+    args[insertPos + 1] = '\0';
+}
+
+const char *embeddedCliGetToken(const char *tokenizedStr, uint16_t pos) {
+    uint16_t i = getTokenPosition(tokenizedStr, pos);
+
+    if (i != CLI_TOKEN_NPOS)
+        return &tokenizedStr[i];
+    else
+        return NULL;
+}
+
+char *embeddedCliGetTokenVariable(char *tokenizedStr, uint16_t pos) {
+    uint16_t i = getTokenPosition(tokenizedStr, pos);
+
+    if (i != CLI_TOKEN_NPOS)
+        return &tokenizedStr[i];
+    else
+        return NULL;
+}
+
+uint16_t embeddedCliFindToken(const char *tokenizedStr, const char *token) {
+    if (tokenizedStr == NULL || token == NULL || tokenizedStr[0] == '\0')
+        return 0;
+
+    size_t len = cliStrLen(token);
+    uint16_t pos = 1;
+    while (true) {
+        size_t tokenLen = cliStrLen(tokenizedStr);
+        if (tokenLen == len && cliMemEqual(tokenizedStr, token, len))
+            return pos;
+        // tokens are ended with double \0
+        tokenizedStr += tokenLen + 1;
+        if (*tokenizedStr == '\0')
+            return 0;
+        ++pos;
+    }
+}
+
+uint16_t embeddedCliGetTokenCount(const char *tokenizedStr) {
+    if (tokenizedStr == NULL || tokenizedStr[0] == '\0')
+        return 0;
+
+    int i = 0;
+    uint16_t tokenCount = 1;
+    while (true) {
+        if (tokenizedStr[i] == '\0') {
+            if (tokenizedStr[i + 1] == '\0')
+                break;
+            ++tokenCount;
+        }
+        ++i;
+    }
+
+    return tokenCount;
+}
+
+void embeddedCliMuxInitDefaultConfig(EmbeddedCliMuxConfig *config) {
+    config->txBufferSize = 128;
+    config->channelCount = 2;
+    config->maxPayloadSize = 64;
+    config->muxBuffer = NULL;
+    config->muxBufferSize = 0;
+}
+
+uint16_t embeddedCliMuxRequiredSize(const EmbeddedCliMuxConfig *config) {
+    // fifo keeps one slot empty
+    return (uint16_t) (CLI_UINT_SIZE * (
+            BYTES_TO_CLI_UINTS(sizeof(EmbeddedCliMux)) +
+            BYTES_TO_CLI_UINTS(sizeof(EmbeddedCliMuxImpl)) +
+            BYTES_TO_CLI_UINTS(config->channelCount * sizeof(CliMuxChannel)) +
+            config->channelCount * BYTES_TO_CLI_UINTS(config->txBufferSize + 1u)));
+}
+
+EmbeddedCliMux *embeddedCliMuxNew(const EmbeddedCliMuxConfig *config) {
+    if (config->channelCount == 0 || config->channelCount > CLI_MUX_MAX_CHANNELS ||
+        config->maxPayloadSize == 0 || config->txBufferSize == 0)
+        return NULL;
+
+    size_t totalSize = embeddedCliMuxRequiredSize(config);
+
+    CLI_UINT *buf = config->muxBuffer;
+    bool allocated = false;
+    if (buf == NULL) {
+        buf = (CLI_UINT *) malloc(totalSize);
+        if (buf == NULL)
+            return NULL;
+        allocated = true;
+    } else if (config->muxBufferSize < totalSize) {
+        return NULL;
+    }
+
+    memset(buf, 0, totalSize);
+
+    EmbeddedCliMux *mux = (EmbeddedCliMux *) buf;
+    buf += BYTES_TO_CLI_UINTS(sizeof(EmbeddedCliMux));
+
+    EmbeddedCliMuxImpl *impl = (EmbeddedCliMuxImpl *) buf;
+    mux->_impl = impl;
+    buf += BYTES_TO_CLI_UINTS(sizeof(EmbeddedCliMuxImpl));
+
+    impl->channels = (CliMuxChannel *) buf;
+    buf += BYTES_TO_CLI_UINTS(config->channelCount * sizeof(CliMuxChannel));
+
+    for (uint8_t i = 0; i < config->channelCount; ++i) {
+        CliMuxChannel *channel = &impl->channels[i];
+        channel->mux = mux;
+        channel->cli = NULL;
+        channel->id = i;
+        channel->txBuffer.buf = (char *) buf;
+        channel->txBuffer.size = (uint16_t) (config->txBufferSize + 1u);
+        buf += BYTES_TO_CLI_UINTS(config->txBufferSize + 1u);
+    }
+
+    impl->channelCount = config->channelCount;
+    impl->maxPayloadSize = config->maxPayloadSize;
+    // everything before first delimiter is discarded
+    impl->rxState = CLI_MUX_RX_SYNC;
+    impl->allocated = allocated;
+
+    return mux;
+}
+
+bool embeddedCliMuxAttach(EmbeddedCliMux *mux, uint8_t channel, EmbeddedCli *cli) {
+    EmbeddedCliMuxImpl *impl = (EmbeddedCliMuxImpl *) mux->_impl;
+    if (channel >= impl->channelCount)
+        return false;
+
+    impl->channels[channel].cli = cli;
+    ((EmbeddedCliImpl *) cli->_impl)->muxChannel = &impl->channels[channel];
+    cli->writeChar = writeMuxOutput;
+    return true;
+}
+
+void embeddedCliMuxReceiveChar(EmbeddedCliMux *mux, char c) {
+    EmbeddedCliMuxImpl *impl = (EmbeddedCliMuxImpl *) mux->_impl;
+    uint8_t b = (uint8_t) c;
+
+    // frames are decoded on the fly, so payload isn't buffered in mux
+    if (b == 0) {
+        impl->rxState = CLI_MUX_RX_TAG;
+        impl->rxCode = 0;
+        impl->rxLeft = 0;
+        return;
+    }
+    if (impl->rxState == CLI_MUX_RX_SYNC)
+        return;
+
+    if (impl->rxLeft > 0) {
+        --impl->rxLeft;
+        onMuxInput(mux, b);
+        return;
+    }
+    // each block except the last and full ones ends with zero
+    bool addZero = impl->rxCode != 0 && impl->rxCode != 0xFF;
+    impl->rxCode = b;
+    impl->rxLeft = (uint8_t) (b - 1);
+    if (addZero)
+        onMuxInput(mux, 0);
+}
+
+void embeddedCliMuxWrite(EmbeddedCliMux *mux, uint8_t channel, const char *data, uint16_t size) {
+    EmbeddedCliMuxImpl *impl = (EmbeddedCliMuxImpl *) mux->_impl;
+    if (channel >= impl->channelCount)
+        return;
+
+    CliMuxChannel *ch = &impl->channels[channel];
+    FifoBuf *tx = &ch->txBuffer;
+    while (size > 0) {
+        uint16_t space = (uint16_t) (tx->size - 1 - fifoBufAvailable(tx));
+        if (space == 0) {
+            writeMuxRound(mux);
+            continue;
+        }
+        // data is copied in contiguous parts instead of single chars
+        uint16_t part = (uint16_t) (tx->size - tx->back);
+        if (part > space)
+            part = space;
+        if (part > size)
+            part = size;
+        memcpy(&tx->buf[tx->back], data, part);
+        tx->back = (uint16_t) ((tx->back + part) % tx->size);
+        data += part;
+        size = (uint16_t) (size - part);
+    }
+}
+
+bool embeddedCliMuxProcess(EmbeddedCliMux *mux) {
+    EmbeddedCliMuxImpl *impl = (EmbeddedCliMuxImpl *) mux->_impl;
+
+    bool pending = false;
+    for (uint8_t i = 0; i < impl->channelCount; ++i) {
+        if (impl->channels[i].cli != NULL && embeddedCliProcess(impl->channels[i].cli))
+            pending = true;
+    }
+
+    while (writeMuxRound(mux)) {}
+
+    return pending;
+}
+
+void embeddedCliMuxFree(EmbeddedCliMux *mux) {
+    EmbeddedCliMuxImpl *impl = (EmbeddedCliMuxImpl *) mux->_impl;
+    if (impl->allocated)
+        free(mux);
+}
+
+static void lockCli(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    if (impl->lock != NULL)
+        impl->lock(cli);
+}
+
+static void unlockCli(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    if (impl->unlock != NULL)
+        impl->unlock(cli);
+}
+
+static bool takeDeferredInput(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    if (!IS_FLAG_SET(impl->flags, CLI_FLAG_INPUT_DEFERRED))
+        return false;
+    UNSET_U16FLAG(impl->flags, CLI_FLAG_INPUT_DEFERRED);
+    return cli->onInputReady != NULL;
+}
+
+static bool addBinding(EmbeddedCli *cli, CliCommandBinding binding) {
+    PREPARE_IMPL(cli);
+    if (impl->bindingsCount == impl->maxBindingsCount)
+        return false;
+
+    if (binding.name == NULL)
+        return false;
+    if (radixTreeFind(&impl->bindingsTree, binding.name, (uint16_t) cliStrLen(binding.name)) != CLI_RADIX_NONE)
+        return false;
+
+    // reuse slot of removed binding if there is any
+    uint16_t slot = impl->freeBindings;
+    if (slot == CLI_RADIX_NONE)
+        slot = impl->bindingSlotsCount;
+
+    impl->bindings[slot] = binding;
+    if (!radixTreeInsert(&impl->bindingsTree, slot)) {
+        // slot stays in list of removed bindings
+        memset(&impl->bindings[slot], 0, sizeof(CliCommandBinding));
+        return false;
+    }
+    if (impl->bindingsStats != NULL)
+        memset(&impl->bindingsStats[slot], 0, sizeof(CliBindingStats));
+
+    if (slot == impl->bindingSlotsCount)
+        ++impl->bindingSlotsCount;
+    else
+        impl->freeBindings = impl->nextFreeBindings[slot];
+    ++impl->bindingsCount;
+    return true;
+}
+
+static bool removeBinding(EmbeddedCli *cli, const char *name) {
+    PREPARE_IMPL(cli);
+    if (name == NULL)
+        return false;
+
+    uint16_t i = radixTreeFind(&impl->bindingsTree, name, (uint16_t) cliStrLen(name));
+    if (i == CLI_RADIX_NONE)
+        return false;
+
+    // watches keep binding index, so they are stopped before slot is reused
+    for (uint16_t w = 0; w < impl->maxWatchesCount; ++w) {
+        if (impl->watches[w].binding == i) {
+            cancelWatches(cli);
+            break;
+        }
+    }
+
+    // candidates subtree might change, so candidates will be searched again
+    resetAutocompleteCandidates(cli);
+    radixTreeRemove(&impl->bindingsTree, i);
+
+    memset(&impl->bindings[i], 0, sizeof(CliCommandBinding));
+    impl->nextFreeBindings[i] = impl->freeBindings;
+    impl->freeBindings = i;
+    impl->bindingsFlags[i] = 0;
+    --impl->bindingsCount;
+    return true;
+}
+
+static bool executeLine(EmbeddedCli *cli, const char *line, uint8_t flags) {
+    PREPARE_IMPL(cli);
+    if (!impl->executeEnabled || line == NULL || cli->writeChar == NULL ||
+        IS_FLAG_SET(impl->flags, CLI_FLAG_EXECUTING))
+        return false;
+
+    // same as with typed command, two extra chars are required for tokenization
+    size_t len = cliStrLen(line);
+    if (len + 2 > impl->cmdMaxSize)
+        return false;
+    memcpy(impl->execBuffer, line, len + 1);
+
+    EmbeddedCli *command = getCommandCli(cli);
+    CliExecution execution = startExecution(command, flags);
+    bool success = parseCommand(command, impl->execBuffer, (uint16_t) len,
+                                IS_FLAG_SET(flags, CLI_EXECUTE_HISTORY));
+    finishExecution(command, execution);
+
+    return success;
+}
+
+static EmbeddedCli *getCommandCli(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    impl->commandCli = *cli;
+    return &impl->commandCli;
+}
+
+static CliScriptResult runScript(EmbeddedCli *cli, const char *script, size_t len,
+                                 const CliScriptOptions *options) {
+    PREPARE_IMPL(cli);
+    CliScriptResult result = {0, 0, 0, 0};
+    if (!impl->executeEnabled || script == NULL || cli->writeChar == NULL ||
+        IS_FLAG_SET(impl->flags, CLI_FLAG_EXECUTING))
+        return result;
+
+    cli = getCommandCli(cli);
+    uint8_t flags = options != NULL ? options->flags : 0;
+    uint32_t start = cli->getTime != NULL ? cli->getTime(cli) : 0;
+    CliExecution execution = startExecution(cli, flags);
+
+    uint16_t lineNumber = 0;
+    size_t pos = 0;
+    while (pos < len && script[pos] != '\0') {
+        size_t lineStart = pos;
+        while (pos < len && script[pos] != '\0' && script[pos] != '\r' && script[pos] != '\n')
+            ++pos;
+        size_t lineEnd = pos;
+        // \r\n is a single line ending
+        if (pos < len && script[pos] == '\r')
+            ++pos;
+        if (pos < len && script[pos] == '\n')
+            ++pos;
+        ++lineNumber;
+
+        while (lineStart < lineEnd && script[lineStart] == ' ')
+            ++lineStart;
+        while (lineEnd > lineStart && script[lineEnd - 1] == ' ')
+            --lineEnd;
+        // skip empty lines and comments
+        if (lineStart == lineEnd || script[lineStart] == '#')
+            continue;
+
+        bool success = lineEnd - lineStart <= UINT16_MAX &&
+                       executeScriptLine(cli, &script[lineStart], (uint16_t) (lineEnd - lineStart), flags);
+        ++result.linesExecuted;
+        if (!success) {
+            ++result.linesFailed;
+            if (result.firstFailedLine == 0)
+                result.firstFailedLine = lineNumber;
+        }
+        if (options != NULL && options->onLineExecuted != NULL)
+            options->onLineExecuted(cli, lineNumber, success, options->context);
+
+        if (!success && IS_FLAG_SET(flags, CLI_SCRIPT_STOP_ON_ERROR))
+            break;
+    }
+
+    finishExecution(cli, execution);
+    if (cli->getTime != NULL)
+        result.time = cli->getTime(cli) - start;
+    return result;
+}
+
+static void navigateHistory(EmbeddedCli *cli, bool navigateUp) {
+    PREPARE_IMPL(cli);
+    if (impl->history.itemsCount == 0 ||
+        (navigateUp && impl->history.current == impl->history.itemsCount) ||
+        (!navigateUp && impl->history.current == 0))
+        return;
+
+    clearCurrentLine(cli);
+
+    writeToOutput(cli, impl->invitation);
+
+    if (navigateUp)
+        ++impl->history.current;
+    else
+        --impl->history.current;
+
+    const char *item = historyGet(&impl->history, impl->history.current);
+    // simple way to handle empty command the same way as others
+    if (item == NULL)
+        item = "";
+    uint16_t len = (uint16_t) cliStrLen(item);
+    memcpy(impl->cmdBuffer, item, len);
+    impl->cmdBuffer[len] = '\0';
+    impl->cmdSize = len;
+
+    writeToOutput(cli, impl->cmdBuffer);
+    impl->inputLineLength = impl->cmdSize;
+
+    printLiveAutocompletion(cli);
+}
+
+static void onEscapedInput(EmbeddedCli *cli, char c) {
+    PREPARE_IMPL(cli);
+
+    if (c >= 64 && c <= 126) {
+        // handle escape sequence
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_ESCAPE_MODE);
+
+        if (c == 'A' || c == 'B') {
+            // treat \e[..A as cursor up and \e[..B as cursor down
+            // there might be extra chars between [ and A/B, just ignore them
+            navigateHistory(cli, c == 'A');
+        }
+    }
+}
+
+static void processInputChar(EmbeddedCli *cli, char c) {
+    PREPARE_IMPL(cli);
+
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_FRAMED)) {
+        onFrameInput(cli, (uint8_t) c);
+        return;
+    }
+
+    if (impl->generator.type != CLI_GENERATOR_NONE) {
+        // any key cancels generated output the same way as watches
+        if (!((impl->lastChar == '\r' && c == '\n') || (impl->lastChar == '\n' && c == '\r')))
+            cancelGenerator(cli);
+        impl->lastChar = c;
+        return;
+    }
+
+    if (impl->watchesCount > 0) {
+        // any key cancels watches (except for the rest of line ending
+        // after command that started them) and is discarded
+        if (!((impl->lastChar == '\r' && c == '\n') || (impl->lastChar == '\n' && c == '\r')))
+            cancelWatches(cli);
+        impl->lastChar = c;
+        return;
+    }
+
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_ESCAPE_MODE)) {
+        onEscapedInput(cli, c);
+    } else if (impl->lastChar == 0x1B && c == '[') {
+        //enter escape mode
+        SET_FLAG(impl->flags, CLI_FLAG_ESCAPE_MODE);
+    } else if (isControlChar(c)) {
+        onControlInput(cli, c);
+    } else if (isDisplayableChar(c)) {
+        onCharInput(cli, c);
+    }
+
+    // input line is not on the screen while output is generated
+    if (impl->generator.type == CLI_GENERATOR_NONE)
+        printLiveAutocompletion(cli);
+
+    impl->lastChar = c;
+}
+
+static void onCharInput(EmbeddedCli *cli, char c) {
+    PREPARE_IMPL(cli);
+
+    // have to reserve two extra chars for command ending (used in tokenization)
+    if (impl->cmdSize + 2 >= impl->cmdMaxSize)
+        return;
+
+    impl->cmdBuffer[impl->cmdSize] = c;
+    ++impl->cmdSize;
+    impl->cmdBuffer[impl->cmdSize] = '\0';
+
+    cli->writeChar(cli, c);
+}
+
+static void onControlInput(EmbeddedCli *cli, char c) {
+    PREPARE_IMPL(cli);
+
+    // process \r\n and \n\r as single \r\n command
+    if ((impl->lastChar == '\r' && c == '\n') ||
+        (impl->lastChar == '\n' && c == '\r'))
+        return;
+
+    if (c == '\r' || c == '\n') {
+        // try to autocomplete command and then process it
+        onAutocompleteRequest(cli);
+
+        writeToOutput(cli, lineBreak);
+
+        if (impl->cmdSize > 0) {
+            if (impl->outputChunkSize > 0)
+                SET_FLAG(impl->flags, CLI_FLAG_INTERACTIVE);
+            SET_FLAG(impl->flags, CLI_FLAG_EXECUTING);
+            parseCommand(getCommandCli(cli), impl->cmdBuffer, impl->cmdSize, true);
+            UNSET_U16FLAG(impl->flags, CLI_FLAG_INTERACTIVE | CLI_FLAG_EXECUTING);
+        }
+        impl->cmdSize = 0;
+        impl->cmdBuffer[impl->cmdSize] = '\0';
+        impl->inputLineLength = 0;
+        impl->history.current = 0;
+
+        // invitation is printed after generated output or when text mode
+        // is restored
+        if (impl->generator.type == CLI_GENERATOR_NONE && !IS_FLAG_SET(impl->flags, CLI_FLAG_FRAMED))
+            writeToOutput(cli, impl->invitation);
+    } else if ((c == '\b' || c == 0x7F) && impl->cmdSize > 0) {
+        // remove char from screen
+        cli->writeChar(cli, '\b');
+        cli->writeChar(cli, ' ');
+        cli->writeChar(cli, '\b');
+        // and from buffer
+        --impl->cmdSize;
+        impl->cmdBuffer[impl->cmdSize] = '\0';
+    } else if (c == '\t') {
+        onAutocompleteRequest(cli);
+    }
+
+}
+
+static bool parseCommand(EmbeddedCli *cli, char *cmd, uint16_t cmdSize, bool putToHistory) {
+    PREPARE_IMPL(cli);
+
+    // do not process empty commands
+    if (isBlank(cmd, cmdSize))
+        return false;
+    // push command to history before buffer is modified
+    if (putToHistory)
+        historyPut(&impl->history, cmd);
+
+    if (!IS_FLAG_SET(impl->flags, CLI_FLAG_CHAINING_ENABLED))
+        return executeCommand(cli, cmd, cmdSize);
+
+    bool success = true;
+    // operator before current command, first command is always executed
+    char op = ';';
+    uint16_t start = 0;
+    while (true) {
+        // find end of command, pipes are part of command
+        uint8_t sepLen = 0;
+        uint16_t end = findSeparator(cmd, start, cmdSize, &sepLen);
+        while (sepLen == 1 && cmd[end] == '|')
+            end = findSeparator(cmd, (uint16_t) (end + 1), cmdSize, &sepLen);
+        char nextOp = sepLen > 0 ? cmd[end] : '\0';
+        // output of chained commands is written at once, otherwise it would
+        // be mixed with output of next command
+        if (nextOp != '\0')
+            UNSET_U16FLAG(impl->flags, CLI_FLAG_INTERACTIVE);
+
+        bool shouldRun = op == ';' || (op == '&' && success) || (op == '|' && !success);
+        if (shouldRun && !isBlank(&cmd[start], (uint16_t) (end - start))) {
+            // tokenization might overwrite first char of next command,
+            // so it is restored after execution
+            char next = cmd[end + 1];
+            cmd[end] = '\0';
+            success = executeCommand(cli, &cmd[start], (uint16_t) (end - start));
+            cmd[end + 1] = next;
+        }
+
+        if (nextOp == '\0')
+            break;
+        op = nextOp;
+        start = (uint16_t) (end + sepLen);
+    }
+    return success;
+}
 
-EmbeddedCliConfig *embeddedCliDefaultConfig(void) {
-    defaultConfig.rxBufferSize = 64;
-    defaultConfig.cmdBufferSize = 64;
-    defaultConfig.historyBufferSize = 128;
-    defaultConfig.cliBuffer = NULL;
-    defaultConfig.cliBufferSize = 0;
-    defaultConfig.maxBindingCount = 8;
-    defaultConfig.enableAutoComplete = true;
-    defaultConfig.invitation = "> ";
-    return &defaultConfig;
+static bool executeCommand(EmbeddedCli *cli, char *cmd, uint16_t cmdSize) {
+    PREPARE_IMPL(cli);
+
+    if (impl->filterBuffer == NULL)
+        return dispatchCommand(cli, cmd, cmdSize);
+
+    // other separators are possible only if chaining is disabled
+    uint8_t sepLen = 0;
+    uint16_t pipe = findSeparator(cmd, 0, cmdSize, &sepLen);
+    while (sepLen > 0 && !(sepLen == 1 && cmd[pipe] == '|'))
+        pipe = findSeparator(cmd, (uint16_t) (pipe + sepLen), cmdSize, &sepLen);
+    if (sepLen == 0)
+        return dispatchCommand(cli, cmd, cmdSize);
+
+    // filters are applied only while command is executed
+    UNSET_U16FLAG(impl->flags, CLI_FLAG_INTERACTIVE);
+
+    // filters are parsed before command, since command tokenization
+    // overwrites first char after it
+    cmd[pipe] = '\0';
+    if (impl->filtersCount > 0) {
+        writeToOutput(cli, "Filtered command can't be executed from other filtered command");
+        writeToOutput(cli, lineBreak);
+        return false;
+    }
+    // filters would be applied only to watch itself, not to periodic output
+    uint16_t nameStart = 0;
+    while (nameStart < pipe && cmd[nameStart] == ' ')
+        ++nameStart;
+    uint16_t nameEnd = nameStart;
+    while (nameEnd < pipe && cmd[nameEnd] != ' ')
+        ++nameEnd;
+    uint16_t binding = radixTreeFind(&impl->bindingsTree, &cmd[nameStart], (uint16_t) (nameEnd - nameStart));
+    if (binding != CLI_RADIX_NONE && impl->bindings[binding].binding == onWatch) {
+        writeToOutput(cli, "Output of watched command can't be filtered");
+        writeToOutput(cli, lineBreak);
+        return false;
+    }
+    if (!parseFilters(cli, &cmd[pipe + 1]))
+        return false;
+
+    impl->filterWriteChar = cli->writeChar;
+    impl->filterLineLength = 0;
+    cli->writeChar = writeFilteredOutput;
+
+    bool success = dispatchCommand(cli, cmd, pipe);
+
+    finishFilters(cli);
+    return success;
 }
 
-uint16_t embeddedCliRequiredSize(EmbeddedCliConfig *config) {
-    uint16_t bindingCount = (uint16_t) (config->maxBindingCount + cliInternalBindingCount);
-    return (uint16_t) (CLI_UINT_SIZE * (
-            BYTES_TO_CLI_UINTS(sizeof(EmbeddedCli)) +
-            BYTES_TO_CLI_UINTS(sizeof(EmbeddedCliImpl)) +
-            BYTES_TO_CLI_UINTS(config->rxBufferSize * sizeof(char)) +
-            BYTES_TO_CLI_UINTS(config->cmdBufferSize * sizeof(char)) +
-            BYTES_TO_CLI_UINTS(config->historyBufferSize * sizeof(char)) +
-            BYTES_TO_CLI_UINTS(bindingCount * sizeof(CliCommandBinding)) +
-            BYTES_TO_CLI_UINTS(bindingCount * sizeof(uint8_t))));
+static bool dispatchCommand(EmbeddedCli *cli, char *cmd, uint16_t cmdSize) {
+    PREPARE_IMPL(cli);
+
+    char *cmdName = NULL;
+    char *cmdArgs = NULL;
+    bool nameFinished = false;
+
+    // find command name and command args inside command buffer
+    for (int i = 0; i < cmdSize; ++i) {
+        char c = cmd[i];
+
+        if (c == ' ') {
+            // all spaces between name and args are filled with zeros
+            // so name is a correct null-terminated string
+            if (cmdArgs == NULL)
+                cmd[i] = '\0';
+            if (cmdName != NULL)
+                nameFinished = true;
+
+        } else if (cmdName == NULL) {
+            cmdName = &cmd[i];
+        } else if (cmdArgs == NULL && nameFinished) {
+            cmdArgs = &cmd[i];
+        }
+    }
+
+    // we keep two last bytes in cmd buffer reserved so cmdSize is always by 2
+    // less than cmdMaxSize
+    cmd[cmdSize + 1] = '\0';
+
+    if (cmdName == NULL)
+        return false;
+
+    // command might be executed from other binding which already prints
+    // directly, so flag is restored afterwards
+    bool directPrint = IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT);
+    bool success = true;
+
+    // try to find command in bindings
+    uint16_t i = radixTreeFind(&impl->bindingsTree, cmdName, (uint16_t) cliStrLen(cmdName));
+    if (i != CLI_RADIX_NONE && impl->bindings[i].binding != NULL) {
+        if (impl->bindings[i].tokenizeArgs)
+            embeddedCliTokenizeArgs(cmdArgs);
+        // currently, output is blank line, so we can just print directly
+        SET_FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
+        success = callBinding(cli, i, cmdArgs);
+    } else if (cli->onCommand != NULL) {
+        // command not found in bindings or binding was null
+        // try to call default callback
+        CliCommand command;
+        command.name = cmdName;
+        command.args = cmdArgs;
+
+        // currently, output is blank line, so we can just print directly
+        SET_FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
+        unlockCli(cli);
+        cli->onCommand(cli, &command);
+        lockCli(cli);
+    } else {
+        onUnknownCommand(cli, cmdName);
+        success = false;
+    }
+
+    if (!directPrint)
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
+    return success;
 }
 
-EmbeddedCli *embeddedCliNew(EmbeddedCliConfig *config) {
-    EmbeddedCli *cli = NULL;
+static uint16_t findSeparator(const char *cmd, uint16_t start, uint16_t cmdSize, uint8_t *sepLen) {
+    bool quotesEnabled = false;
+    bool escapeActivated = false;
+    for (uint16_t i = start; i < cmdSize; ++i) {
+        char c = cmd[i];
+        if (escapeActivated) {
+            escapeActivated = false;
+        } else if (c == '\\') {
+            escapeActivated = true;
+        } else if (c == '"') {
+            quotesEnabled = !quotesEnabled;
+        } else if (quotesEnabled) {
+            continue;
+        } else if (c == ';') {
+            *sepLen = 1;
+            return i;
+        } else if ((c == '&' || c == '|') && cmd[i + 1] == c) {
+            *sepLen = 2;
+            return i;
+        } else if (c == '|') {
+            *sepLen = 1;
+            return i;
+        }
+    }
+    *sepLen = 0;
+    return cmdSize;
+}
 
-    uint16_t bindingCount = (uint16_t) (config->maxBindingCount + cliInternalBindingCount);
+static bool parseFilters(EmbeddedCli *cli, char *filters) {
+    PREPARE_IMPL(cli);
 
-    size_t totalSize = embeddedCliRequiredSize(config);
+    impl->filtersCount = 0;
+    uint16_t len = (uint16_t) cliStrLen(filters);
+    uint16_t start = 0;
+    bool valid = true;
+    while (valid && start <= len) {
+        uint8_t sepLen = 0;
+        uint16_t end = findSeparator(filters, start, len, &sepLen);
+        // only pipes are allowed between filters
+        if (impl->filtersCount == CLI_MAX_FILTERS || (sepLen != 0 && (sepLen != 1 || filters[end] != '|'))) {
+            valid = false;
+            break;
+        }
+        filters[end] = '\0';
+
+        // filter name is followed by optional argument
+        char *name = &filters[start];
+        while (*name == ' ')
+            ++name;
+        char *arg = name;
+        while (*arg != ' ' && *arg != '\0')
+            ++arg;
+        if (*arg != '\0')
+            *arg++ = '\0';
+        while (*arg == ' ')
+            ++arg;
+        char *argEnd = &filters[end];
+        while (argEnd > arg && argEnd[-1] == ' ')
+            --argEnd;
+        if (argEnd - arg >= 2 && arg[0] == '"' && argEnd[-1] == '"') {
+            ++arg;
+            --argEnd;
+        }
+        *argEnd = '\0';
+
+        CliFilter *filter = &impl->filters[impl->filtersCount];
+        filter->pattern = arg;
+        filter->value = 0;
+        if (strcmp(name, "grep") == 0 && *arg != '\0') {
+            filter->type = CLI_FILTER_GREP;
+        } else if (strcmp(name, "head") == 0 && *arg != '\0') {
+            filter->type = CLI_FILTER_HEAD;
+            for (const char *c = arg; *c != '\0' && valid; ++c) {
+                valid = *c >= '0' && *c <= '9' && filter->value < 100000000u;
+                filter->value = filter->value * 10 + (uint32_t) (*c - '0');
+            }
+        } else if (strcmp(name, "count") == 0 && *arg == '\0') {
+            filter->type = CLI_FILTER_COUNT;
+        } else {
+            valid = false;
+        }
+        ++impl->filtersCount;
+        start = (uint16_t) (end + 1);
+    }
 
-    bool allocated = false;
-    if (config->cliBuffer == NULL) {
-        config->cliBuffer = (CLI_UINT *) malloc(totalSize); // malloc guarantees alignment.
-        if (config->cliBuffer == NULL)
-            return NULL;
-        allocated = true;
-    } else if (config->cliBufferSize < totalSize) {
-        return NULL;
+    if (!valid) {
+        impl->filtersCount = 0;
+        writeToOutput(cli, "Invalid filter. Available filters: grep <pattern>, head <lines>, count");
+        writeToOutput(cli, lineBreak);
     }
+    return valid;
+}
 
-    CLI_UINT *buf = config->cliBuffer;
+static void writeFilteredOutput(EmbeddedCli *cli, char c) {
+    PREPARE_IMPL(cli);
 
-    memset(buf, 0, totalSize);
+    // line break is printed together with passed line, longer lines are
+    // truncated
+    if (c == '\n') {
+        passFilteredLine(cli, 0);
+    } else if (c != '\r' && impl->filterLineLength + 1 < impl->filterBufferSize) {
+        impl->filterBuffer[impl->filterLineLength] = c;
+        ++impl->filterLineLength;
+    }
+}
 
-    cli = (EmbeddedCli *) buf;
-    buf += BYTES_TO_CLI_UINTS(sizeof(EmbeddedCli));
+static void passFilteredLine(EmbeddedCli *cli, uint8_t filter) {
+    PREPARE_IMPL(cli);
 
-    cli->_impl = (EmbeddedCliImpl *) buf;
-    buf += BYTES_TO_CLI_UINTS(sizeof(EmbeddedCliImpl));
+    uint16_t len = impl->filterLineLength;
+    impl->filterBuffer[len] = '\0';
+    impl->filterLineLength = 0;
+
+    for (uint8_t i = filter; i < impl->filtersCount; ++i) {
+        CliFilter *f = &impl->filters[i];
+        if (f->type == CLI_FILTER_GREP && strstr(impl->filterBuffer, f->pattern) == NULL)
+            return;
+        if (f->type == CLI_FILTER_HEAD && f->value == 0)
+            return;
+        if (f->type == CLI_FILTER_HEAD)
+            --f->value;
+        if (f->type == CLI_FILTER_COUNT) {
+            ++f->value;
+            return;
+        }
+    }
+
+    for (uint16_t i = 0; i < len; ++i) {
+        impl->filterWriteChar(cli, impl->filterBuffer[i]);
+    }
+    impl->filterWriteChar(cli, '\r');
+    impl->filterWriteChar(cli, '\n');
+}
 
+static void finishFilters(EmbeddedCli *cli) {
     PREPARE_IMPL(cli);
-    impl->rxBuffer.buf = (char *) buf;
-    buf += BYTES_TO_CLI_UINTS(config->rxBufferSize * sizeof(char));
 
-    impl->cmdBuffer = (char *) buf;
-    buf += BYTES_TO_CLI_UINTS(config->cmdBufferSize * sizeof(char));
+    if (impl->filterLineLength > 0)
+        passFilteredLine(cli, 0);
 
-    impl->bindings = (CliCommandBinding *) buf;
-    buf += BYTES_TO_CLI_UINTS(bindingCount * sizeof(CliCommandBinding));
+    // count is printed as a line that goes through next filters
+    for (uint8_t i = 0; i < impl->filtersCount; ++i) {
+        if (impl->filters[i].type != CLI_FILTER_COUNT)
+            continue;
+        writeNumber(cli, impl->filters[i].value);
+        passFilteredLine(cli, (uint8_t) (i + 1));
+    }
 
-    impl->bindingsFlags = (uint8_t *) buf;
-    buf += BYTES_TO_CLI_UINTS(bindingCount);
+    cli->writeChar = impl->filterWriteChar;
+    impl->filtersCount = 0;
+}
 
-    impl->history.buf = (char *) buf;
-    impl->history.bufferSize = config->historyBufferSize;
+static uint16_t getInternalBindingCount(const EmbeddedCliConfig *config) {
+    uint16_t count = 1;
+    if (config->enableBindingStats)
+        ++count;
+    if (config->maxWatchCount > 0)
+        ++count;
+    return count;
+}
 
-    if (allocated)
-        SET_FLAG(impl->flags, CLI_FLAG_ALLOCATED);
+static bool hasExecBuffer(const EmbeddedCliConfig *config) {
+    return config->enableExecute || config->maxWatchCount > 0;
+}
 
-    if (config->enableAutoComplete)
-        SET_FLAG(impl->flags, CLI_FLAG_AUTOCOMPLETE_ENABLED);
+static void initInternalBindings(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
 
-    impl->rxBuffer.size = config->rxBufferSize;
-    impl->rxBuffer.front = 0;
-    impl->rxBuffer.back = 0;
-    impl->cmdMaxSize = config->cmdBufferSize;
-    impl->bindingsCount = 0;
-    impl->maxBindingsCount = (uint16_t) (config->maxBindingCount + cliInternalBindingCount);
-    impl->lastChar = '\0';
-    impl->invitation = config->invitation;
+    CliCommandBinding b = {
+            "help",
+            "Print list of commands",
+            true,
+            NULL,
+            onHelp
+    };
+    addInternalBinding(cli, b);
+
+    if (impl->bindingsStats != NULL) {
+        CliCommandBinding stats = {
+                "stats",
+                "Print call count, error count and latency histogram of commands",
+                true,
+                NULL,
+                onStats
+        };
+        addInternalBinding(cli, stats);
+    }
+
+    if (impl->maxWatchesCount > 0) {
+        CliCommandBinding watch = {
+                "watch",
+                "Execute command periodically until any key is pressed\r\n"
+                "\tUsage: watch <ms> <command> [args...]",
+                false,
+                NULL,
+                onWatch
+        };
+        addInternalBinding(cli, watch);
+    }
+}
+
+static void addInternalBinding(EmbeddedCli *cli, CliCommandBinding binding) {
+    PREPARE_IMPL(cli);
+
+    if (!addBinding(cli, binding))
+        return;
+    uint16_t i = radixTreeFind(&impl->bindingsTree, binding.name, (uint16_t) cliStrLen(binding.name));
+    impl->bindingsFlags[i] |= BINDING_FLAG_INTERNAL;
+}
+
+static bool callBinding(EmbeddedCli *cli, uint16_t binding, char *args) {
+    PREPARE_IMPL(cli);
+    // binding might be removed or replaced from other thread while cli is
+    // unlocked, so it is copied
+    CliCommandBinding b = impl->bindings[binding];
+    bool internal = IS_FLAG_SET(impl->bindingsFlags[binding], BINDING_FLAG_INTERNAL);
+
+    // binding might be called from other binding, so its state is restored
+    bool callerFailed = IS_FLAG_SET(impl->flags, CLI_FLAG_COMMAND_FAILED);
+    UNSET_U16FLAG(impl->flags, CLI_FLAG_COMMAND_FAILED);
+
+    uint32_t start = 0;
+    if (impl->bindingsStats != NULL && cli->getTime != NULL)
+        start = cli->getTime(cli);
+
+    if (internal) {
+        b.binding(cli, args, b.context);
+    } else {
+        unlockCli(cli);
+        b.binding(cli, args, b.context);
+        lockCli(cli);
+    }
+
+    bool failed = IS_FLAG_SET(impl->flags, CLI_FLAG_COMMAND_FAILED);
+    if (!callerFailed)
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_COMMAND_FAILED);
+
+    // binding might remove itself, then its stats are already discarded
+    if (impl->bindingsStats == NULL || impl->bindings[binding].name == NULL)
+        return !failed;
+
+    CliBindingStats *stats = &impl->bindingsStats[binding];
+    ++stats->calls;
+    if (failed)
+        ++stats->errors;
+
+    if (cli->getTime == NULL)
+        return !failed;
+
+    // unsigned subtraction handles overflow of timer
+    uint32_t duration = cli->getTime(cli) - start;
+    uint8_t bucket = 0;
+    while (duration != 0 && bucket < CLI_LATENCY_BUCKETS - 1) {
+        duration >>= 1;
+        ++bucket;
+    }
+    if (stats->latency[bucket] != UINT16_MAX)
+        ++stats->latency[bucket];
+    return !failed;
+}
+
+static CliExecution startExecution(EmbeddedCli *cli, uint8_t flags) {
+    PREPARE_IMPL(cli);
+
+    CliExecution execution;
+    execution.writeChar = cli->writeChar;
+    bool showOutput = IS_FLAG_SET(flags, CLI_EXECUTE_OUTPUT);
+    // current input is printed again only if it is already on the screen
+    execution.redraw = showOutput && IS_FLAG_SET(impl->flags, CLI_FLAG_INIT_COMPLETE) &&
+                       !IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT) &&
+                       impl->generator.type == CLI_GENERATOR_NONE;
+
+    if (!showOutput) {
+        cli->writeChar = writeNothing;
+        SET_FLAG(impl->flags, CLI_FLAG_HIDDEN_OUTPUT);
+    } else if (execution.redraw) {
+        clearCurrentLine(cli);
+    }
+
+    SET_FLAG(impl->flags, CLI_FLAG_EXECUTING);
+    return execution;
+}
+
+static void finishExecution(EmbeddedCli *cli, CliExecution execution) {
+    PREPARE_IMPL(cli);
+
+    UNSET_U16FLAG(impl->flags, CLI_FLAG_EXECUTING | CLI_FLAG_HIDDEN_OUTPUT);
+    cli->writeChar = execution.writeChar;
+
+    if (execution.redraw) {
+        writeToOutput(cli, impl->invitation);
+        writeToOutput(cli, impl->cmdBuffer);
+        impl->inputLineLength = impl->cmdSize;
+
+        printLiveAutocompletion(cli);
+    }
+}
+
+static bool executeScriptLine(EmbeddedCli *cli, const char *line, uint16_t len, uint8_t flags) {
+    PREPARE_IMPL(cli);
+
+    uint16_t nameLen = 0;
+    while (nameLen < len && line[nameLen] != ' ')
+        ++nameLen;
+
+    // binding without args can be called straight from script, since it
+    // doesn't need mutable buffer
+    uint16_t i = radixTreeFind(&impl->bindingsTree, line, nameLen);
+    if (nameLen == len && i != CLI_RADIX_NONE && impl->bindings[i].binding != NULL &&
+        !IS_FLAG_SET(flags, CLI_EXECUTE_HISTORY)) {
+        bool directPrint = IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT);
+        SET_FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
+        bool success = callBinding(cli, i, NULL);
+        if (!directPrint)
+            UNSET_U16FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
+        return success;
+    }
+
+    // same as with typed command, two extra chars are required for tokenization
+    if (len + 2 > impl->cmdMaxSize)
+        return false;
+    memcpy(impl->execBuffer, line, len);
+    impl->execBuffer[len] = '\0';
+    return parseCommand(cli, impl->execBuffer, len, IS_FLAG_SET(flags, CLI_EXECUTE_HISTORY));
+}
+
+static void onFrameInput(EmbeddedCli *cli, uint8_t c) {
+    PREPARE_IMPL(cli);
+
+    if (c == 0) {
+        if (!IS_FLAG_SET(impl->flags, CLI_FLAG_FRAME_SYNC) && impl->frameCode != 0)
+            onFrameReceived(getCommandCli(cli));
+        impl->frameSize = 0;
+        impl->frameCode = 0;
+        impl->frameLeft = 0;
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_FRAME_SYNC | CLI_FLAG_FRAME_OVERFLOW);
+        return;
+    }
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_FRAME_SYNC))
+        return;
+
+    bool isCode = impl->frameLeft == 0;
+    // each block except the last and full ones ends with zero
+    bool addZero = isCode && impl->frameCode != 0 && impl->frameCode != 0xFF;
+    if (isCode) {
+        impl->frameCode = c;
+        impl->frameLeft = (uint8_t) (c - 1);
+    } else {
+        --impl->frameLeft;
+    }
+    if (!isCode || addZero) {
+        if (impl->frameSize + 1u > impl->frameBufferSize) {
+            SET_FLAG(impl->flags, CLI_FLAG_FRAME_OVERFLOW);
+            return;
+        }
+        impl->frameBuffer[impl->frameSize++] = isCode ? 0 : c;
+    }
+}
+
+static void onFrameReceived(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    uint8_t *frame = impl->frameBuffer;
+
+    // id and crc are required, crc is replaced by double null after args
+    bool valid = !IS_FLAG_SET(impl->flags, CLI_FLAG_FRAME_OVERFLOW) && impl->frameLeft == 0 &&
+                 impl->frameSize >= 4;
+    uint16_t crc = CLI_FRAME_CRC_INIT;
+    for (uint16_t i = 0; valid && i + 2u < impl->frameSize; ++i) {
+        crc = updateFrameCrc(crc, frame[i]);
+    }
+    if (!valid || crc != readU16(&frame[impl->frameSize - 2])) {
+        startFrameResponse(cli, CLI_BINDING_ID_NONE);
+        finishFrameResponse(cli, CLI_FRAME_STATUS_INVALID);
+        return;
+    }
+
+    uint16_t id = readU16(frame);
+    uint16_t argsLen = (uint16_t) (impl->frameSize - 4);
+    frame[impl->frameSize - 2] = 0;
+    frame[impl->frameSize - 1] = 0;
+    char *args = argsLen > 0 ? (char *) &frame[2] : NULL;
+
+    startFrameResponse(cli, id);
+    uint8_t status = CLI_FRAME_STATUS_UNKNOWN;
+    // output of watches is drawn on screen, it can't be written in frames
+    if (id < impl->bindingSlotsCount && impl->bindings[id].name != NULL && impl->bindings[id].binding != NULL &&
+        impl->bindings[id].binding != onWatch) {
+        // output is already separated from everything else
+        bool directPrint = IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT);
+        SET_FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT | CLI_FLAG_EXECUTING);
+        status = (uint8_t) (callBinding(cli, id, args) ? CLI_FRAME_STATUS_OK : CLI_FRAME_STATUS_FAILED);
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_EXECUTING);
+        if (!directPrint)
+            UNSET_U16FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
+    }
+    finishFrameResponse(cli, status);
+}
+
+static void startFrameResponse(EmbeddedCli *cli, uint16_t id) {
+    PREPARE_IMPL(cli);
+
+    impl->frameWriteChar = cli->writeChar;
+    // leading delimiter lets host drop anything that was written before
+    impl->frameWriteChar(cli, '\0');
+    impl->frameCrc = CLI_FRAME_CRC_INIT;
+    impl->frameBlockSize = 0;
+    cli->writeChar = writeFramedOutput;
+
+    writeFrameByte(cli, (uint8_t) (id & 0xFFu));
+    writeFrameByte(cli, (uint8_t) (id >> 8));
+}
+
+static void finishFrameResponse(EmbeddedCli *cli, uint8_t status) {
+    PREPARE_IMPL(cli);
+
+    writeFrameByte(cli, status);
+    uint16_t crc = impl->frameCrc;
+    encodeFrameByte(cli, (uint8_t) (crc & 0xFFu));
+    encodeFrameByte(cli, (uint8_t) (crc >> 8));
+    flushFrameBlock(cli, (uint8_t) (impl->frameBlockSize + 1));
+    impl->frameWriteChar(cli, '\0');
+
+    cli->writeChar = impl->frameWriteChar;
+}
+
+static void writeFramedOutput(EmbeddedCli *cli, char c) {
+    writeFrameByte(cli, (uint8_t) c);
+}
+
+static void writeFrameByte(EmbeddedCli *cli, uint8_t b) {
+    PREPARE_IMPL(cli);
+    impl->frameCrc = updateFrameCrc(impl->frameCrc, b);
+    encodeFrameByte(cli, b);
+}
+
+static void encodeFrameByte(EmbeddedCli *cli, uint8_t b) {
+    PREPARE_IMPL(cli);
+
+    if (b == 0) {
+        flushFrameBlock(cli, (uint8_t) (impl->frameBlockSize + 1));
+        return;
+    }
+    impl->frameBlock[impl->frameBlockSize++] = b;
+    if (impl->frameBlockSize == CLI_FRAME_BLOCK_SIZE)
+        flushFrameBlock(cli, 0xFF);
+}
+
+static void flushFrameBlock(EmbeddedCli *cli, uint8_t code) {
+    PREPARE_IMPL(cli);
+
+    impl->frameWriteChar(cli, (char) code);
+    for (uint8_t i = 0; i < impl->frameBlockSize; ++i) {
+        impl->frameWriteChar(cli, (char) impl->frameBlock[i]);
+    }
+    impl->frameBlockSize = 0;
+}
+
+static void onTelnetInput(EmbeddedCli *cli, uint8_t b) {
+    PREPARE_IMPL(cli);
+
+    switch (impl->telnetState) {
+        case CLI_TELNET_DATA:
+        case CLI_TELNET_CR:
+            // \r\0 and \r\n are both received as return
+            if (impl->telnetState == CLI_TELNET_CR && b == 0) {
+                impl->telnetState = CLI_TELNET_DATA;
+            } else if (b == CLI_TELNET_IAC) {
+                impl->telnetState = CLI_TELNET_COMMAND;
+            } else {
+                impl->telnetState = b == '\r' ? CLI_TELNET_CR : CLI_TELNET_DATA;
+                embeddedCliReceiveChar(cli, (char) b);
+            }
+            break;
+        case CLI_TELNET_COMMAND:
+            impl->telnetCommand = b;
+            if (b == CLI_TELNET_IAC) {
+                // escaped 0xFF data byte
+                impl->telnetState = CLI_TELNET_DATA;
+                embeddedCliReceiveChar(cli, (char) b);
+            } else if (b >= CLI_TELNET_WILL) {
+                impl->telnetState = CLI_TELNET_OPTION;
+            } else if (b == CLI_TELNET_SB) {
+                impl->telnetState = CLI_TELNET_SB_OPTION;
+            } else {
+                // other commands (NOP, GA, AYT, ...) are ignored
+                impl->telnetState = CLI_TELNET_DATA;
+            }
+            break;
+        case CLI_TELNET_OPTION:
+            impl->telnetState = CLI_TELNET_DATA;
+            onTelnetOption(cli, impl->telnetCommand, b);
+            break;
+        case CLI_TELNET_SB_OPTION:
+            impl->telnetCommand = b;
+            impl->telnetSbSize = 0;
+            impl->telnetState = CLI_TELNET_SB_DATA;
+            break;
+        case CLI_TELNET_SB_DATA:
+            if (b == CLI_TELNET_IAC)
+                impl->telnetState = CLI_TELNET_SB_IAC;
+            else if (impl->telnetSbSize < sizeof(impl->telnetSb))
+                impl->telnetSb[impl->telnetSbSize++] = b;
+            break;
+        default:
+            if (b == CLI_TELNET_IAC) {
+                impl->telnetState = CLI_TELNET_SB_DATA;
+                if (impl->telnetSbSize < sizeof(impl->telnetSb))
+                    impl->telnetSb[impl->telnetSbSize++] = b;
+                break;
+            }
+            // NAWS contains width and height (both u16 big endian)
+            if (b == CLI_TELNET_SE && impl->telnetCommand == CLI_TELNET_OPT_NAWS && impl->telnetSbSize == 4)
+                impl->windowWidth = (uint16_t) ((impl->telnetSb[0] << 8) | impl->telnetSb[1]);
+            impl->telnetState = CLI_TELNET_DATA;
+            break;
+    }
+}
 
-    initInternalBindings(cli);
+static void onTelnetOption(EmbeddedCli *cli, uint8_t command, uint8_t option) {
+    PREPARE_IMPL(cli);
 
-    return cli;
-}
+    uint8_t flag = 0;
+    if (command == CLI_TELNET_DO || command == CLI_TELNET_DONT) {
+        if (option == CLI_TELNET_OPT_ECHO)
+            flag = CLI_TELNET_ECHO;
+        else if (option == CLI_TELNET_OPT_SGA)
+            flag = CLI_TELNET_SGA;
+    } else {
+        if (option == CLI_TELNET_OPT_SGA)
+            flag = CLI_TELNET_CLIENT_SGA;
+        else if (option == CLI_TELNET_OPT_NAWS)
+            flag = CLI_TELNET_NAWS;
+    }
 
-EmbeddedCli *embeddedCliNewDefault(void) {
-    return embeddedCliNew(embeddedCliDefaultConfig());
+    // reply is sent only when state changes, otherwise negotiation loops
+    bool enabled = IS_FLAG_SET(impl->telnetOptions, flag);
+    if (command == CLI_TELNET_DO && flag == 0) {
+        queueTelnetReply(cli, CLI_TELNET_WONT, option);
+    } else if (command == CLI_TELNET_WILL && flag == 0) {
+        queueTelnetReply(cli, CLI_TELNET_DONT, option);
+    } else if ((command == CLI_TELNET_DO || command == CLI_TELNET_WILL) && !enabled) {
+        impl->telnetOptions |= flag;
+        queueTelnetReply(cli, command == CLI_TELNET_DO ? CLI_TELNET_WILL : CLI_TELNET_DO, option);
+    } else if ((command == CLI_TELNET_DONT || command == CLI_TELNET_WONT) && enabled) {
+        impl->telnetOptions = (uint8_t) (impl->telnetOptions & ~flag);
+        queueTelnetReply(cli, command == CLI_TELNET_DONT ? CLI_TELNET_WONT : CLI_TELNET_DONT, option);
+    }
 }
 
-void embeddedCliReceiveChar(EmbeddedCli *cli, char c) {
+static void queueTelnetReply(EmbeddedCli *cli, uint8_t command, uint8_t option) {
     PREPARE_IMPL(cli);
 
-    if (!fifoBufPush(&impl->rxBuffer, c)) {
-        SET_FLAG(impl->flags, CLI_FLAG_OVERFLOW);
+    // reply is dropped if there is no space for it
+    if ((uint16_t) (fifoBufAvailable(&impl->telnetReplies) + 2) < CLI_TELNET_REPLIES_SIZE) {
+        fifoBufPush(&impl->telnetReplies, (char) command);
+        fifoBufPush(&impl->telnetReplies, (char) option);
+        // reply should be written even if no input follows
+        if (cli->onInputReady != NULL)
+            cli->onInputReady(cli);
     }
 }
 
-void embeddedCliProcess(EmbeddedCli *cli) {
-    if (cli->writeChar == NULL)
-        return;
+static void writeTelnetCommand(EmbeddedCli *cli, uint8_t command, uint8_t option) {
+    PREPARE_IMPL(cli);
+    void (*writeChar)(EmbeddedCli *cli, char c) =
+            impl->telnetWriteChar != NULL ? impl->telnetWriteChar : cli->writeChar;
+
+    writeChar(cli, (char) CLI_TELNET_IAC);
+    writeChar(cli, (char) command);
+    writeChar(cli, (char) option);
+}
 
+static void writeTelnetOutput(EmbeddedCli *cli, char c) {
     PREPARE_IMPL(cli);
 
+    if ((uint8_t) c == CLI_TELNET_IAC)
+        impl->telnetWriteChar(cli, c);
+    impl->telnetWriteChar(cli, c);
+}
 
-    if (!IS_FLAG_SET(impl->flags, CLI_FLAG_INIT_COMPLETE)) {
-        SET_FLAG(impl->flags, CLI_FLAG_INIT_COMPLETE);
-        writeToOutput(cli, impl->invitation);
+static void writeMuxOutput(EmbeddedCli *cli, char c) {
+    PREPARE_IMPL(cli);
+    CliMuxChannel *channel = impl->muxChannel;
+
+    // other channels also get their turn, so busy channel doesn't block them
+    if (!fifoBufPush(&channel->txBuffer, c)) {
+        writeMuxRound(channel->mux);
+        fifoBufPush(&channel->txBuffer, c);
     }
+}
 
-    while (fifoBufAvailable(&impl->rxBuffer)) {
-        char c = fifoBufPop(&impl->rxBuffer);
-
-        if (IS_FLAG_SET(impl->flags, CLI_FLAG_ESCAPE_MODE)) {
-            onEscapedInput(cli, c);
-        } else if (impl->lastChar == 0x1B && c == '[') {
-            //enter escape mode
-            SET_FLAG(impl->flags, CLI_FLAG_ESCAPE_MODE);
-        } else if (isControlChar(c)) {
-            onControlInput(cli, c);
-        } else if (isDisplayableChar(c)) {
-            onCharInput(cli, c);
+static bool writeMuxRound(EmbeddedCliMux *mux) {
+    EmbeddedCliMuxImpl *impl = (EmbeddedCliMuxImpl *) mux->_impl;
+
+    bool written = false;
+    for (uint8_t i = 0; i < impl->channelCount; ++i) {
+        CliMuxChannel *channel = &impl->channels[(impl->nextChannel + i) % impl->channelCount];
+        if (fifoBufAvailable(&channel->txBuffer) > 0) {
+            writeMuxFrame(mux, channel);
+            written = true;
         }
+    }
+    impl->nextChannel = (uint8_t) ((impl->nextChannel + 1) % impl->channelCount);
+    return written;
+}
 
-        printLiveAutocompletion(cli);
+static void writeMuxFrame(EmbeddedCliMux *mux, CliMuxChannel *channel) {
+    EmbeddedCliMuxImpl *impl = (EmbeddedCliMuxImpl *) mux->_impl;
+    FifoBuf *tx = &channel->txBuffer;
 
-        impl->lastChar = c;
-    }
+    uint16_t size = fifoBufAvailable(tx);
+    if (size > impl->maxPayloadSize)
+        size = impl->maxPayloadSize;
 
-    // discard unfinished command if overflow happened
-    if (IS_FLAG_SET(impl->flags, CLI_FLAG_OVERFLOW)) {
-        impl->cmdSize = 0;
-        impl->cmdBuffer[impl->cmdSize] = '\0';
-        UNSET_U8FLAG(impl->flags, CLI_FLAG_OVERFLOW);
+    // delimiter separates first frame from anything written before mux
+    char delimiter = '\0';
+    if (!impl->started) {
+        mux->write(mux, &delimiter, 1);
+        impl->started = true;
     }
-}
 
-bool embeddedCliAddBinding(EmbeddedCli *cli, CliCommandBinding binding) {
-    PREPARE_IMPL(cli);
-    if (impl->bindingsCount == impl->maxBindingsCount)
-        return false;
+    // tag and payload are COBS encoded, blocks are written straight from
+    // output buffer. Tag is never zero, so it always starts the first block
+    uint16_t offset = 0;
+    bool first = true;
+    while (true) {
+        uint16_t maxLen = (uint16_t) (first ? CLI_COBS_MAX_BLOCK - 1 : CLI_COBS_MAX_BLOCK);
+        uint16_t len = 0;
+        while (offset + len < size && len < maxLen &&
+               tx->buf[(tx->front + offset + len) % tx->size] != '\0')
+            ++len;
+
+        char header[2] = {(char) (first ? len + 2 : len + 1), (char) (CLI_MUX_TAG | channel->id)};
+        mux->write(mux, header, first ? 2 : 1);
+        writeMuxPart(mux, tx, offset, len);
+        offset = (uint16_t) (offset + len);
+        first = false;
+
+        if (offset == size)
+            break;
+        // zero that ended the block is encoded by its code
+        if (len < maxLen)
+            ++offset;
+    }
+    mux->write(mux, &delimiter, 1);
 
-    impl->bindings[impl->bindingsCount] = binding;
+    tx->front = (uint16_t) ((tx->front + size) % tx->size);
+}
 
-    ++impl->bindingsCount;
-    return true;
+static void writeMuxPart(EmbeddedCliMux *mux, FifoBuf *tx, uint16_t offset, uint16_t size) {
+    uint16_t start = (uint16_t) ((tx->front + offset) % tx->size);
+    uint16_t first = (uint16_t) (tx->size - start);
+    if (first > size)
+        first = size;
+    if (first > 0)
+        mux->write(mux, &tx->buf[start], first);
+    if (size > first)
+        mux->write(mux, tx->buf, (uint16_t) (size - first));
 }
 
-void embeddedCliPrint(EmbeddedCli *cli, const char *string) {
-    if (cli->writeChar == NULL)
+static void onMuxInput(EmbeddedCliMux *mux, uint8_t b) {
+    EmbeddedCliMuxImpl *impl = (EmbeddedCliMuxImpl *) mux->_impl;
+
+    if (impl->rxState == CLI_MUX_RX_TAG) {
+        // frames of unknown channels are skipped
+        if ((b & 0xF0u) == CLI_MUX_TAG && (b & 0x0Fu) < impl->channelCount) {
+            impl->rxChannel = (uint8_t) (b & 0x0Fu);
+            impl->rxState = CLI_MUX_RX_PAYLOAD;
+        } else {
+            impl->rxState = CLI_MUX_RX_SYNC;
+        }
         return;
+    }
 
-    PREPARE_IMPL(cli);
+    CliMuxChannel *channel = &impl->channels[impl->rxChannel];
+    if (channel->cli != NULL)
+        embeddedCliReceiveChar(channel->cli, (char) b);
+    else if (mux->onInput != NULL)
+        mux->onInput(mux, channel->id, (char) b);
+}
 
-    // remove chars for autocompletion and live command
-    if (!IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT))
-        clearCurrentLine(cli);
+static uint16_t updateFrameCrc(uint16_t crc, uint8_t b) {
+    crc ^= (uint16_t) (b << 8);
+    for (uint8_t i = 0; i < 8; ++i) {
+        unsigned shifted = (unsigned) crc << 1u;
+        crc = (uint16_t) ((crc & 0x8000u) != 0 ? shifted ^ 0x1021u : shifted);
+    }
+    return crc;
+}
 
-    // print provided string
-    writeToOutput(cli, string);
-    writeToOutput(cli, lineBreak);
+static void writeNothing(EmbeddedCli *cli, char c) {
+    UNUSED(cli);
+    UNUSED(c);
+}
 
-    // print current command back to screen
-    if (!IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT)) {
-        writeToOutput(cli, impl->invitation);
-        writeToOutput(cli, impl->cmdBuffer);
-        impl->inputLineLength = impl->cmdSize;
+static void onHelp(EmbeddedCli *cli, char *tokens, void *context) {
+    UNUSED(context);
+    PREPARE_IMPL(cli);
 
-        printLiveAutocompletion(cli);
+    if (impl->bindingsCount == 0) {
+        writeToOutput(cli, "Help is not available");
+        writeToOutput(cli, lineBreak);
+        return;
+    }
+
+    uint16_t tokenCount = embeddedCliGetTokenCount(tokens);
+    if (tokenCount == 0 && canGenerateOutput(cli)) {
+        startGenerator(cli, CLI_GENERATOR_HELP);
+    } else if (tokenCount == 0) {
+        for (uint16_t i = 0; i < impl->bindingSlotsCount; ++i) {
+            if (impl->bindings[i].name != NULL)
+                printBindingHelp(cli, i);
+        }
+    } else if (tokenCount == 1) {
+        // try find command
+        const char *helpStr = NULL;
+        const char *cmdName = embeddedCliGetToken(tokens, 1);
+        uint16_t i = radixTreeFind(&impl->bindingsTree, cmdName, (uint16_t) cliStrLen(cmdName));
+        bool found = i != CLI_RADIX_NONE;
+        if (found)
+            helpStr = impl->bindings[i].help;
+        if (found && helpStr != NULL) {
+            writeToOutput(cli, " * ");
+            writeToOutput(cli, cmdName);
+            writeToOutput(cli, lineBreak);
+            cli->writeChar(cli, '\t');
+            writeHelp(cli, helpStr);
+            writeToOutput(cli, lineBreak);
+        } else if (found) {
+            writeToOutput(cli, "Help is not available");
+            writeToOutput(cli, lineBreak);
+        } else {
+            onUnknownCommand(cli, cmdName);
+        }
+    } else {
+        writeToOutput(cli, "Command \"help\" receives one or zero arguments");
+        writeToOutput(cli, lineBreak);
     }
 }
 
-void embeddedCliFree(EmbeddedCli *cli) {
+static void onStats(EmbeddedCli *cli, char *tokens, void *context) {
+    UNUSED(context);
     PREPARE_IMPL(cli);
-    if (IS_FLAG_SET(impl->flags, CLI_FLAG_ALLOCATED)) {
-        // allocation is done in single call to malloc, so need only single free
-        free(cli);
+
+    uint16_t tokenCount = embeddedCliGetTokenCount(tokens);
+    if (tokenCount == 0 && canGenerateOutput(cli)) {
+        startGenerator(cli, CLI_GENERATOR_STATS);
+    } else if (tokenCount == 0) {
+        for (uint16_t i = 0; i < impl->bindingSlotsCount; ++i) {
+            if (impl->bindings[i].name != NULL)
+                printBindingStats(cli, i);
+        }
+    } else if (tokenCount == 1) {
+        const char *cmdName = embeddedCliGetToken(tokens, 1);
+        uint16_t i = radixTreeFind(&impl->bindingsTree, cmdName, (uint16_t) cliStrLen(cmdName));
+        if (i != CLI_RADIX_NONE)
+            printBindingStats(cli, i);
+        else
+            onUnknownCommand(cli, cmdName);
+    } else {
+        writeToOutput(cli, "Command \"stats\" receives one or zero arguments");
+        writeToOutput(cli, lineBreak);
     }
 }
 
-void embeddedCliTokenizeArgs(char *args) {
-    if (args == NULL)
-        return;
-
-    // for now only space, but can add more later
-    const char *separators = " ";
+static void onWatch(EmbeddedCli *cli, char *args, void *context) {
+    UNUSED(context);
+    PREPARE_IMPL(cli);
 
-    // indicates that arg is quoted so separators are copied as is
-    bool quotesEnabled = false;
-    // indicates that previous char was a slash, so next char is copied as is
-    bool escapeActivated = false;
-    int insertPos = 0;
+    // args are not tokenized, so args of watched command are stored exactly
+    // as they were typed
+    char *periodStr = args;
+    while (periodStr != NULL && *periodStr == ' ')
+        ++periodStr;
+    char *cmdName = periodStr != NULL && *periodStr != '\0' ? splitWatchArg(periodStr) : NULL;
+    char *cmdArgs = cmdName != NULL ? splitWatchArg(cmdName) : NULL;
+    if (cmdName == NULL) {
+        writeToOutput(cli, "Usage: watch <ms> <command> [args...]");
+        writeToOutput(cli, lineBreak);
+        SET_FLAG(impl->flags, CLI_FLAG_COMMAND_FAILED);
+        return;
+    }
+    if (cli->getTime == NULL) {
+        writeToOutput(cli, "Command \"watch\" requires getTime callback");
+        writeToOutput(cli, lineBreak);
+        SET_FLAG(impl->flags, CLI_FLAG_COMMAND_FAILED);
+        return;
+    }
 
-    int i = 0;
-    char currentChar;
-    while ((currentChar = args[i]) != '\0') {
-        ++i;
+    uint32_t period = 0;
+    bool periodValid = true;
+    for (const char *c = periodStr; *c != '\0' && periodValid; ++c) {
+        periodValid = *c >= '0' && *c <= '9' && period < 100000000u;
+        period = period * 10 + (uint32_t) (*c - '0');
+    }
+    // deadlines are compared within half of timer range
+    if (!periodValid || period == 0 || period > 0x7FFFFFFFu / impl->ticksPerMs) {
+        writeToOutput(cli, "Invalid period: \"");
+        writeToOutput(cli, periodStr);
+        writeToOutput(cli, "\"");
+        writeToOutput(cli, lineBreak);
+        SET_FLAG(impl->flags, CLI_FLAG_COMMAND_FAILED);
+        return;
+    }
 
-        if (escapeActivated) {
-            escapeActivated = false;
-        } else if (currentChar == '\\') {
-            escapeActivated = true;
-            continue;
-        } else if (currentChar == '"') {
-            quotesEnabled = !quotesEnabled;
-            currentChar = '\0';
-        } else if (!quotesEnabled && strchr(separators, currentChar) != NULL) {
-            currentChar = '\0';
-        }
+    uint16_t binding = radixTreeFind(&impl->bindingsTree, cmdName, (uint16_t) cliStrLen(cmdName));
+    if (binding == CLI_RADIX_NONE || impl->bindings[binding].binding == NULL ||
+        impl->bindings[binding].binding == onWatch) {
+        onUnknownCommand(cli, cmdName);
+        SET_FLAG(impl->flags, CLI_FLAG_COMMAND_FAILED);
+        return;
+    }
 
-        // null chars are only copied once and not copied to the beginning
-        if (currentChar != '\0' || (insertPos > 0 && args[insertPos - 1] != '\0')) {
-            args[insertPos] = currentChar;
-            ++insertPos;
-        }
+    CliWatch *watch = NULL;
+    for (uint16_t i = 0; i < impl->maxWatchesCount && watch == NULL; ++i) {
+        if (impl->watches[i].binding == CLI_RADIX_NONE)
+            watch = &impl->watches[i];
+    }
+    if (watch == NULL) {
+        writeToOutput(cli, "Too many watched commands");
+        writeToOutput(cli, lineBreak);
+        SET_FLAG(impl->flags, CLI_FLAG_COMMAND_FAILED);
+        return;
     }
 
-    // make args double null-terminated source buffer must be big enough to contain extra spaces
-    args[insertPos] = '\0';
-    args[insertPos + 1] = '\0';
+    watch->argsLen = 0;
+    if (cmdArgs != NULL) {
+        // args are stored in the same form as they are received by binding:
+        // tokens or single string ending with double null
+        uint16_t len = (uint16_t) cliStrLen(cmdArgs);
+        memcpy(watch->args, cmdArgs, len);
+        watch->args[len] = '\0';
+        watch->args[len + 1] = '\0';
+        watch->argsLen = (uint16_t) (len + 2);
+        if (impl->bindings[binding].tokenizeArgs)
+            embeddedCliTokenizeArgs(watch->args);
+    }
+    watch->binding = binding;
+    watch->period = period * impl->ticksPerMs;
+    watch->deadline = cli->getTime(cli);
+    watch->lines = 0;
+    ++impl->watchesCount;
 }
 
-const char *embeddedCliGetToken(const char *tokenizedStr, uint16_t pos) {
-    uint16_t i = getTokenPosition(tokenizedStr, pos);
-
-    if (i != CLI_TOKEN_NPOS)
-        return &tokenizedStr[i];
-    else
-        return NULL;
+static char *splitWatchArg(char *arg) {
+    while (*arg != ' ' && *arg != '\0')
+        ++arg;
+    while (*arg == ' ')
+        *arg++ = '\0';
+    return *arg != '\0' ? arg : NULL;
 }
 
-char *embeddedCliGetTokenVariable(char *tokenizedStr, uint16_t pos) {
-    uint16_t i = getTokenPosition(tokenizedStr, pos);
+static void processWatches(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
 
-    if (i != CLI_TOKEN_NPOS)
-        return &tokenizedStr[i];
-    else
-        return NULL;
-}
+    // watches can't be executed while other command uses exec buffer or
+    // between frames
+    if (impl->watchesCount > 0 && cli->getTime != NULL &&
+        !IS_FLAG_SET(impl->flags, CLI_FLAG_EXECUTING | CLI_FLAG_FRAMED)) {
+        for (uint16_t i = 0; i < impl->maxWatchesCount && impl->watchesCount > 0; ++i) {
+            CliWatch *watch = &impl->watches[i];
+            uint32_t now = cli->getTime(cli);
+            // unsigned subtraction handles overflow of timer
+            if (watch->binding == CLI_RADIX_NONE || now - watch->deadline >= 0x80000000u)
+                continue;
+
+            runWatch(getCommandCli(cli), i);
+
+            // if execution is late for whole period, skip missed executions
+            watch->deadline += watch->period;
+            if (now - watch->deadline < 0x80000000u)
+                watch->deadline = now + watch->period;
+        }
+    }
 
-uint16_t embeddedCliFindToken(const char *tokenizedStr, const char *token) {
-    if (tokenizedStr == NULL || token == NULL)
-        return 0;
+    if (impl->watchesCount == 0 && IS_FLAG_SET(impl->flags, CLI_FLAG_WATCH_SCREEN)) {
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_WATCH_SCREEN);
+        writeToOutput(cli, impl->invitation);
+        writeToOutput(cli, impl->cmdBuffer);
+        impl->inputLineLength = impl->cmdSize;
 
-    uint16_t size = embeddedCliGetTokenCount(tokenizedStr);
-    for (uint16_t i = 1; i <= size; ++i) {
-        if (strcmp(embeddedCliGetToken(tokenizedStr, i), token) == 0)
-            return i;
+        printLiveAutocompletion(cli);
     }
-
-    return 0;
 }
 
-uint16_t embeddedCliGetTokenCount(const char *tokenizedStr) {
-    if (tokenizedStr == NULL || tokenizedStr[0] == '\0')
-        return 0;
+static bool getNextWatchDeadline(EmbeddedCli *cli, uint32_t *deadline) {
+    PREPARE_IMPL(cli);
 
-    int i = 0;
-    uint16_t tokenCount = 1;
-    while (true) {
-        if (tokenizedStr[i] == '\0') {
-            if (tokenizedStr[i + 1] == '\0')
-                break;
-            ++tokenCount;
+    if (impl->watchesCount == 0 || cli->getTime == NULL)
+        return false;
+
+    // deadlines are compared relative to current time, so overflow of
+    // timer is handled. Late watches are the earliest ones
+    uint32_t now = cli->getTime(cli);
+    uint32_t minLeft = UINT32_MAX;
+    for (uint16_t i = 0; i < impl->maxWatchesCount; ++i) {
+        CliWatch *watch = &impl->watches[i];
+        if (watch->binding == CLI_RADIX_NONE)
+            continue;
+        uint32_t left = watch->deadline - now;
+        if (left >= 0x80000000u)
+            left = 0;
+        if (left < minLeft) {
+            minLeft = left;
+            *deadline = watch->deadline;
         }
-        ++i;
     }
-
-    return tokenCount;
+    return true;
 }
 
-static void navigateHistory(EmbeddedCli *cli, bool navigateUp) {
+static void runWatch(EmbeddedCli *cli, uint16_t watch) {
     PREPARE_IMPL(cli);
-    if (impl->history.itemsCount == 0 ||
-        (navigateUp && impl->history.current == impl->history.itemsCount) ||
-        (!navigateUp && impl->history.current == 0))
-        return;
+    CliWatch *w = &impl->watches[watch];
 
-    clearCurrentLine(cli);
-
-    writeToOutput(cli, impl->invitation);
+    // first output replaces invitation and current command
+    if (!IS_FLAG_SET(impl->flags, CLI_FLAG_WATCH_SCREEN)) {
+        clearCurrentLine(cli);
+        SET_FLAG(impl->flags, CLI_FLAG_WATCH_SCREEN);
+    }
 
-    if (navigateUp)
-        ++impl->history.current;
-    else
-        --impl->history.current;
+    // cursor is always kept at the line after output of all watches
+    uint16_t linesAfter = 0;
+    for (uint16_t i = (uint16_t) (watch + 1); i < impl->maxWatchesCount; ++i) {
+        if (impl->watches[i].binding != CLI_RADIX_NONE)
+            linesAfter = (uint16_t) (linesAfter + impl->watches[i].lines);
+    }
+    moveCursor(cli, (uint16_t) (linesAfter + w->lines), 'A');
+
+    impl->watchWriteChar = cli->writeChar;
+    impl->watchLines = 0;
+    impl->watchLastChar = '\n';
+    cli->writeChar = writeWatchOutput;
+
+    // binding might modify its args, so it receives a copy
+    char *args = NULL;
+    if (w->argsLen > 0) {
+        memcpy(impl->execBuffer, w->args, w->argsLen);
+        args = impl->execBuffer;
+    }
+    bool directPrint = IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT);
+    SET_FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT | CLI_FLAG_EXECUTING);
+    callBinding(cli, w->binding, args);
+    UNSET_U16FLAG(impl->flags, CLI_FLAG_EXECUTING);
+    if (!directPrint)
+        UNSET_U16FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
+
+    if (impl->watchLastChar != '\n')
+        writeToOutput(cli, lineBreak);
+    cli->writeChar = impl->watchWriteChar;
 
-    const char *item = historyGet(&impl->history, impl->history.current);
-    // simple way to handle empty command the same way as others
-    if (item == NULL)
-        item = "";
-    uint16_t len = (uint16_t) strlen(item);
-    memcpy(impl->cmdBuffer, item, len);
-    impl->cmdBuffer[len] = '\0';
-    impl->cmdSize = len;
+    // binding might cancel watches, then output is just left as is
+    if (w->binding == CLI_RADIX_NONE)
+        return;
 
-    writeToOutput(cli, impl->cmdBuffer);
-    impl->inputLineLength = impl->cmdSize;
+    if (impl->watchLines == w->lines) {
+        moveCursor(cli, linesAfter, 'B');
+        return;
+    }
 
-    printLiveAutocompletion(cli);
+    // output of next watches is shifted, so it is cleared and will be
+    // printed again on their next execution
+    writeToOutput(cli, "\x1B[J");
+    w->lines = impl->watchLines;
+    for (uint16_t i = (uint16_t) (watch + 1); i < impl->maxWatchesCount; ++i) {
+        impl->watches[i].lines = 0;
+    }
 }
 
-static void onEscapedInput(EmbeddedCli *cli, char c) {
+static void cancelWatches(EmbeddedCli *cli) {
     PREPARE_IMPL(cli);
 
-    if (c >= 64 && c <= 126) {
-        // handle escape sequence
-        UNSET_U8FLAG(impl->flags, CLI_FLAG_ESCAPE_MODE);
-
-        if (c == 'A' || c == 'B') {
-            // treat \e[..A as cursor up and \e[..B as cursor down
-            // there might be extra chars between [ and A/B, just ignore them
-            navigateHistory(cli, c == 'A');
-        }
+    for (uint16_t i = 0; i < impl->maxWatchesCount; ++i) {
+        impl->watches[i].binding = CLI_RADIX_NONE;
+        impl->watches[i].lines = 0;
     }
+    impl->watchesCount = 0;
 }
 
-static void onCharInput(EmbeddedCli *cli, char c) {
+static void writeWatchOutput(EmbeddedCli *cli, char c) {
     PREPARE_IMPL(cli);
 
-    // have to reserve two extra chars for command ending (used in tokenization)
-    if (impl->cmdSize + 2 >= impl->cmdMaxSize)
-        return;
-
-    impl->cmdBuffer[impl->cmdSize] = c;
-    ++impl->cmdSize;
-    impl->cmdBuffer[impl->cmdSize] = '\0';
+    // clear rest of the line, previous output might be longer
+    if (c == '\r' || (c == '\n' && impl->watchLastChar != '\r')) {
+        impl->watchWriteChar(cli, 0x1B);
+        impl->watchWriteChar(cli, '[');
+        impl->watchWriteChar(cli, 'K');
+    }
+    impl->watchWriteChar(cli, c);
 
-    cli->writeChar(cli, c);
+    if (c == '\n' && impl->watchLines < UINT16_MAX)
+        ++impl->watchLines;
+    impl->watchLastChar = c;
 }
 
-static void onControlInput(EmbeddedCli *cli, char c) {
-    PREPARE_IMPL(cli);
-
-    // process \r\n and \n\r as single \r\n command
-    if ((impl->lastChar == '\r' && c == '\n') ||
-        (impl->lastChar == '\n' && c == '\r'))
+static void moveCursor(EmbeddedCli *cli, uint16_t lines, char direction) {
+    if (lines == 0)
         return;
 
-    if (c == '\r' || c == '\n') {
-        // try to autocomplete command and then process it
-        onAutocompleteRequest(cli);
+    cli->writeChar(cli, 0x1B);
+    cli->writeChar(cli, '[');
+    writeNumber(cli, lines);
+    cli->writeChar(cli, direction);
+}
 
-        writeToOutput(cli, lineBreak);
+static void printBindingStats(EmbeddedCli *cli, uint16_t binding) {
+    PREPARE_IMPL(cli);
+    const CliBindingStats *stats = &impl->bindingsStats[binding];
+
+    writeToOutput(cli, " * ");
+    writeToOutput(cli, impl->bindings[binding].name);
+    writeToOutput(cli, ": ");
+    writeNumber(cli, stats->calls);
+    writeToOutput(cli, stats->calls == 1 ? " call, " : " calls, ");
+    writeNumber(cli, stats->errors);
+    writeToOutput(cli, stats->errors == 1 ? " error" : " errors");
+    writeToOutput(cli, lineBreak);
 
-        if (impl->cmdSize > 0)
-            parseCommand(cli);
-        impl->cmdSize = 0;
-        impl->cmdBuffer[impl->cmdSize] = '\0';
-        impl->inputLineLength = 0;
-        impl->history.current = 0;
+    if (cli->getTime == NULL || stats->calls == 0)
+        return;
 
-        writeToOutput(cli, impl->invitation);
-    } else if ((c == '\b' || c == 0x7F) && impl->cmdSize > 0) {
-        // remove char from screen
-        cli->writeChar(cli, '\b');
+    // print only non-empty buckets as "<upper bound:count"
+    cli->writeChar(cli, '\t');
+    for (uint8_t i = 0; i < CLI_LATENCY_BUCKETS; ++i) {
+        if (stats->latency[i] == 0)
+            continue;
+        if (i == CLI_LATENCY_BUCKETS - 1) {
+            writeToOutput(cli, ">=");
+            writeNumber(cli, 1u << (i - 1));
+        } else {
+            cli->writeChar(cli, '<');
+            writeNumber(cli, 1u << i);
+        }
+        cli->writeChar(cli, ':');
+        writeNumber(cli, stats->latency[i]);
         cli->writeChar(cli, ' ');
-        cli->writeChar(cli, '\b');
-        // and from buffer
-        --impl->cmdSize;
-        impl->cmdBuffer[impl->cmdSize] = '\0';
-    } else if (c == '\t') {
-        onAutocompleteRequest(cli);
     }
-
+    writeToOutput(cli, lineBreak);
 }
 
-static void parseCommand(EmbeddedCli *cli) {
+static void printBindingHelp(EmbeddedCli *cli, uint16_t binding) {
     PREPARE_IMPL(cli);
 
-    bool isEmpty = true;
-
-    for (int i = 0; i < impl->cmdSize; ++i) {
-        if (impl->cmdBuffer[i] != ' ') {
-            isEmpty = false;
-            break;
-        }
+    writeToOutput(cli, " * ");
+    writeToOutput(cli, impl->bindings[binding].name);
+    writeToOutput(cli, lineBreak);
+    if (impl->bindings[binding].help != NULL) {
+        cli->writeChar(cli, '\t');
+        writeHelp(cli, impl->bindings[binding].help);
+        writeToOutput(cli, lineBreak);
     }
-    // do not process empty commands
-    if (isEmpty)
-        return;
-    // push command to history before buffer is modified
-    historyPut(&impl->history, impl->cmdBuffer);
-
-    char *cmdName = NULL;
-    char *cmdArgs = NULL;
-    bool nameFinished = false;
+}
 
-    // find command name and command args inside command buffer
-    for (int i = 0; i < impl->cmdSize; ++i) {
-        char c = impl->cmdBuffer[i];
+static void writeHelp(EmbeddedCli *cli, const char *help) {
+    PREPARE_IMPL(cli);
 
-        if (c == ' ') {
-            // all spaces between name and args are filled with zeros
-            // so name is a correct null-terminated string
-            if (cmdArgs == NULL)
-                impl->cmdBuffer[i] = '\0';
-            if (cmdName != NULL)
-                nameFinished = true;
+    if (impl->helpDictionary == NULL || help[0] != CLI_HELP_COMPRESSED) {
+        writeToOutput(cli, help);
+        return;
+    }
 
-        } else if (cmdName == NULL) {
-            cmdName = &impl->cmdBuffer[i];
-        } else if (cmdArgs == NULL && nameFinished) {
-            cmdArgs = &impl->cmdBuffer[i];
-        }
+    for (const char *c = help + 1; *c != '\0'; ++c) {
+        uint8_t code = (uint8_t) *c;
+        if (code < 0x80u)
+            cli->writeChar(cli, *c);
+        else
+            writeToOutput(cli, impl->helpDictionary[code - 0x80u]);
     }
+}
 
-    // we keep two last bytes in cmd buffer reserved so cmdSize is always by 2
-    // less than cmdMaxSize
-    impl->cmdBuffer[impl->cmdSize + 1] = '\0';
+static bool canGenerateOutput(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    // commands from embeddedCliExecute and watches are written at once
+    return IS_FLAG_SET(impl->flags, CLI_FLAG_INTERACTIVE) &&
+           impl->generator.type == CLI_GENERATOR_NONE;
+}
 
-    if (cmdName == NULL)
-        return;
+static void startGenerator(EmbeddedCli *cli, uint8_t type) {
+    PREPARE_IMPL(cli);
+    CliGenerator *gen = &impl->generator;
 
-    // try to find command in bindings
-    for (int i = 0; i < impl->bindingsCount; ++i) {
-        if (strcmp(cmdName, impl->bindings[i].name) == 0) {
-            if (impl->bindings[i].binding == NULL)
-                break;
+    gen->type = type;
+    gen->item = 0;
+    gen->offset = 0;
+    gen->lastChar = '\n';
+}
 
-            if (impl->bindings[i].tokenizeArgs)
-                embeddedCliTokenizeArgs(cmdArgs);
-            // currently, output is blank line, so we can just print directly
-            SET_FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
-            impl->bindings[i].binding(cli, cmdArgs, impl->bindings[i].context);
-            UNSET_U8FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
-            return;
+static void runGenerator(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    CliGenerator *gen = &impl->generator;
+
+    gen->writeChar = cli->writeChar;
+    gen->budget = impl->outputChunkSize;
+    cli->writeChar = writeGeneratedOutput;
+
+    while (gen->item < impl->bindingSlotsCount && gen->budget > 0) {
+        if (impl->bindings[gen->item].name != NULL) {
+            gen->skip = gen->offset;
+            gen->truncated = false;
+            if (gen->type == CLI_GENERATOR_HELP)
+                printBindingHelp(cli, gen->item);
+            else
+                printBindingStats(cli, gen->item);
+            // rest of item is written by next call
+            if (gen->truncated)
+                break;
         }
+        ++gen->item;
+        gen->offset = 0;
     }
 
-    // command not found in bindings or binding was null
-    // try to call default callback
-    if (cli->onCommand != NULL) {
-        CliCommand command;
-        command.name = cmdName;
-        command.args = cmdArgs;
+    cli->writeChar = gen->writeChar;
 
-        // currently, output is blank line, so we can just print directly
-        SET_FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
-        cli->onCommand(cli, &command);
-        UNSET_U8FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
-    } else {
-        onUnknownCommand(cli, cmdName);
+    if (gen->item >= impl->bindingSlotsCount) {
+        gen->type = CLI_GENERATOR_NONE;
+        writeToOutput(cli, impl->invitation);
     }
 }
 
-static void initInternalBindings(EmbeddedCli *cli) {
-    CliCommandBinding b = {
-            "help",
-            "Print list of commands",
-            true,
-            NULL,
-            onHelp
-    };
-    embeddedCliAddBinding(cli, b);
+static void cancelGenerator(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+
+    if (impl->generator.lastChar != '\n')
+        writeToOutput(cli, lineBreak);
+    impl->generator.type = CLI_GENERATOR_NONE;
+    writeToOutput(cli, impl->invitation);
 }
 
-static void onHelp(EmbeddedCli *cli, char *tokens, void *context) {
-    UNUSED(context);
+static void writeGeneratedOutput(EmbeddedCli *cli, char c) {
     PREPARE_IMPL(cli);
+    CliGenerator *gen = &impl->generator;
 
-    if (impl->bindingsCount == 0) {
-        writeToOutput(cli, "Help is not available");
-        writeToOutput(cli, lineBreak);
+    if (gen->skip > 0) {
+        --gen->skip;
         return;
     }
-
-    uint16_t tokenCount = embeddedCliGetTokenCount(tokens);
-    if (tokenCount == 0) {
-        for (int i = 0; i < impl->bindingsCount; ++i) {
-            writeToOutput(cli, " * ");
-            writeToOutput(cli, impl->bindings[i].name);
-            writeToOutput(cli, lineBreak);
-            if (impl->bindings[i].help != NULL) {
-                cli->writeChar(cli, '\t');
-                writeToOutput(cli, impl->bindings[i].help);
-                writeToOutput(cli, lineBreak);
-            }
-        }
-    } else if (tokenCount == 1) {
-        // try find command
-        const char *helpStr = NULL;
-        const char *cmdName = embeddedCliGetToken(tokens, 1);
-        bool found = false;
-        for (int i = 0; i < impl->bindingsCount; ++i) {
-            if (strcmp(impl->bindings[i].name, cmdName) == 0) {
-                helpStr = impl->bindings[i].help;
-                found = true;
-                break;
-            }
-        }
-        if (found && helpStr != NULL) {
-            writeToOutput(cli, " * ");
-            writeToOutput(cli, cmdName);
-            writeToOutput(cli, lineBreak);
-            cli->writeChar(cli, '\t');
-            writeToOutput(cli, helpStr);
-            writeToOutput(cli, lineBreak);
-        } else if (found) {
-            writeToOutput(cli, "Help is not available");
-            writeToOutput(cli, lineBreak);
-        } else {
-            onUnknownCommand(cli, cmdName);
-        }
-    } else {
-        writeToOutput(cli, "Command \"help\" receives one or zero arguments");
-        writeToOutput(cli, lineBreak);
+    if (gen->budget == 0) {
+        gen->truncated = true;
+        return;
     }
+    --gen->budget;
+    ++gen->offset;
+    gen->lastChar = c;
+    gen->writeChar(cli, c);
 }
 
 static void onUnknownCommand(EmbeddedCli *cli, const char *name) {
@@ -892,57 +4259,42 @@ static void onUnknownCommand(EmbeddedCli *cli, const char *name) {
 static AutocompletedCommand getAutocompletedCommand(EmbeddedCli *cli, const char *prefix) {
     AutocompletedCommand cmd = {NULL, 0, 0};
 
-    size_t prefixLen = strlen(prefix);
-
     PREPARE_IMPL(cli);
-    if (impl->bindingsCount == 0 || prefixLen == 0)
-        return cmd;
-
+    CliRadixTree *tree = &impl->bindingsTree;
 
-    for (int i = 0; i < impl->bindingsCount; ++i) {
-        const char *name = impl->bindings[i].name;
-        size_t len = strlen(name);
-
-        // unset autocomplete flag
-        UNSET_U8FLAG(impl->bindingsFlags[i], BINDING_FLAG_AUTOCOMPLETE);
-
-        if (len < prefixLen)
-            continue;
+    resetAutocompleteCandidates(cli);
 
-        // check if this command is candidate for autocomplete
-        bool isCandidate = true;
-        for (size_t j = 0; j < prefixLen; ++j) {
-            if (prefix[j] != name[j]) {
-                isCandidate = false;
-                break;
-            }
-        }
-        if (!isCandidate)
-            continue;
+    if (impl->bindingsCount == 0 || prefix[0] == '\0')
+        return cmd;
 
-        impl->bindingsFlags[i] |= BINDING_FLAG_AUTOCOMPLETE;
+    uint16_t root = radixTreeFindPrefix(tree, prefix);
+    if (root == CLI_RADIX_NONE)
+        return cmd;
 
-        if (cmd.candidateCount == 0 || len < cmd.autocompletedLen)
-            cmd.autocompletedLen = (uint16_t) len;
+    impl->candidatesRoot = root;
+    cmd.firstCandidate = impl->bindings[tree->nodes[root].binding].name;
+    cmd.autocompletedLen = tree->nodes[root].depth;
 
+    uint16_t node = CLI_RADIX_NONE;
+    while ((node = radixTreeNextTerminal(tree, root, node)) != CLI_RADIX_NONE) {
+        impl->bindingsFlags[tree->nodes[node].binding] |= BINDING_FLAG_AUTOCOMPLETE;
         ++cmd.candidateCount;
-
-        if (cmd.candidateCount == 1) {
-            cmd.firstCandidate = name;
-            continue;
-        }
-
-        for (size_t j = impl->cmdSize; j < cmd.autocompletedLen; ++j) {
-            if (cmd.firstCandidate[j] != name[j]) {
-                cmd.autocompletedLen = (uint16_t) j;
-                break;
-            }
-        }
     }
 
     return cmd;
 }
 
+static void resetAutocompleteCandidates(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    CliRadixTree *tree = &impl->bindingsTree;
+
+    uint16_t node = CLI_RADIX_NONE;
+    while ((node = radixTreeNextTerminal(tree, impl->candidatesRoot, node)) != CLI_RADIX_NONE) {
+        UNSET_U8FLAG(impl->bindingsFlags[tree->nodes[node].binding], BINDING_FLAG_AUTOCOMPLETE);
+    }
+    impl->candidatesRoot = CLI_RADIX_NONE;
+}
+
 static void printLiveAutocompletion(EmbeddedCli *cli) {
     PREPARE_IMPL(cli);
 
@@ -998,7 +4350,7 @@ static void onAutocompleteRequest(EmbeddedCli *cli) {
     // we need to completely clear current line since it begins with invitation
     clearCurrentLine(cli);
 
-    for (int i = 0; i < impl->bindingsCount; ++i) {
+    for (int i = 0; i < impl->bindingSlotsCount; ++i) {
         // autocomplete flag is set for all candidates by last call to
         // getAutocompletedCommand
         if (!(impl->bindingsFlags[i] & BINDING_FLAG_AUTOCOMPLETE))
@@ -1018,7 +4370,7 @@ static void onAutocompleteRequest(EmbeddedCli *cli) {
 
 static void clearCurrentLine(EmbeddedCli *cli) {
     PREPARE_IMPL(cli);
-    size_t len = impl->inputLineLength + strlen(impl->invitation);
+    size_t len = impl->inputLineLength + cliStrLen(impl->invitation);
 
     cli->writeChar(cli, '\r');
     for (size_t i = 0; i < len; ++i) {
@@ -1029,11 +4381,30 @@ static void clearCurrentLine(EmbeddedCli *cli) {
 }
 
 static void writeToOutput(EmbeddedCli *cli, const char *str) {
-    size_t len = strlen(str);
+    for (; *str != '\0'; ++str) {
+        cli->writeChar(cli, *str);
+    }
+}
 
-    for (size_t i = 0; i < len; ++i) {
-        cli->writeChar(cli, str[i]);
+static void writeNumber(EmbeddedCli *cli, uint32_t value) {
+    char digits[10];
+    uint8_t len = 0;
+    do {
+        digits[len++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (len > 0) {
+        cli->writeChar(cli, digits[--len]);
+    }
+}
+
+static bool isBlank(const char *str, uint16_t len) {
+    for (uint16_t i = 0; i < len; ++i) {
+        if (str[i] != ' ')
+            return false;
     }
+    return true;
 }
 
 static bool isControlChar(char c) {
@@ -1044,6 +4415,37 @@ static bool isDisplayableChar(char c) {
     return (c >= 32 && c <= 126);
 }
 
+static uint8_t getInputReadyTrigger(EmbeddedCliImpl *impl, char c) {
+    // request is complete only at frame delimiter, other bytes are binary
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_FRAMED)) {
+        impl->rxEscapeState = CLI_RX_ESCAPE_NONE;
+        return c == '\0' ? CLI_INPUT_READY_LINE_END : CLI_INPUT_READY_OTHER;
+    }
+    if (c == 0x1B) {
+        impl->rxEscapeState = CLI_RX_ESCAPE_START;
+        return 0;
+    }
+    if (impl->rxEscapeState == CLI_RX_ESCAPE_START) {
+        if (c == '[') {
+            impl->rxEscapeState = CLI_RX_ESCAPE_CSI;
+            return 0;
+        }
+        impl->rxEscapeState = CLI_RX_ESCAPE_NONE;
+    } else if (impl->rxEscapeState == CLI_RX_ESCAPE_CSI) {
+        // sequence ends with char in range 0x40-0x7E
+        if (c < 0x40 || c > 0x7E)
+            return 0;
+        impl->rxEscapeState = CLI_RX_ESCAPE_NONE;
+        return CLI_INPUT_READY_ESCAPE;
+    }
+
+    if (c == '\r' || c == '\n')
+        return CLI_INPUT_READY_LINE_END;
+    if (c == '\t')
+        return CLI_INPUT_READY_TAB;
+    return CLI_INPUT_READY_OTHER;
+}
+
 static uint16_t fifoBufAvailable(FifoBuf *buffer) {
     if (buffer->back >= buffer->front)
         return (uint16_t) (buffer->back - buffer->front);
@@ -1071,7 +4473,7 @@ static bool fifoBufPush(FifoBuf *buffer, char a) {
 }
 
 static bool historyPut(CliHistory *history, const char *str) {
-    size_t len = strlen(str);
+    size_t len = cliStrLen(str);
     // each item is ended with \0 so, need to have that much space at least
     if (history->bufferSize < len + 1)
         return false;
@@ -1083,7 +4485,7 @@ static bool historyPut(CliHistory *history, const char *str) {
     // remove old items if new one can't fit into buffer
     while (history->itemsCount > 0) {
         const char *item = historyGet(history, history->itemsCount);
-        size_t itemLen = strlen(item);
+        size_t itemLen = cliStrLen(item);
         usedSize = ((size_t) (item - history->buf)) + itemLen + 1;
 
         size_t freeSpace = history->bufferSize - usedSize;
@@ -1116,18 +4518,18 @@ static const char *historyGet(CliHistory *history, uint16_t item) {
 static void historyRemove(CliHistory *history, const char *str) {
     if (str == NULL || history->itemsCount == 0)
         return;
-    char *item = NULL;
+    size_t len = cliStrLen(str);
+    char *item = history->buf;
     uint16_t itemPosition;
     for (itemPosition = 1; itemPosition <= history->itemsCount; ++itemPosition) {
-        // items are stored in the same way (separated by \0 and counted from 1),
-        // so can use this call
-        item = embeddedCliGetTokenVariable(history->buf, itemPosition);
-        if (strcmp(item, str) == 0) {
+        // items are separated by \0, so they can be walked without
+        // searching each one from the beginning
+        size_t itemLen = cliStrLen(item);
+        if (itemLen == len && cliMemEqual(item, str, len))
             break;
-        }
-        item = NULL;
+        item += itemLen + 1;
     }
-    if (item == NULL)
+    if (itemPosition > history->itemsCount)
         return;
 
     --history->itemsCount;
@@ -1136,12 +4538,89 @@ static void historyRemove(CliHistory *history, const char *str) {
         return;
     }
 
-    size_t len = strlen(item);
     size_t remaining = (size_t) (history->bufferSize - (item + len + 1 - history->buf));
     // move everything to the right of found item
     memmove(item, &item[len + 1], remaining);
 }
 
+static uint16_t historyUsedSize(CliHistory *history) {
+    const char *last = historyGet(history, history->itemsCount);
+    if (last == NULL)
+        return 0;
+    return (uint16_t) (last - history->buf + (ptrdiff_t) cliStrLen(last) + 1);
+}
+
+static size_t cliStrLen(const char *str) {
+#ifdef CLI_WORD_STRINGS
+    const char *p = str;
+    while (((uintptr_t) p % CLI_UINT_SIZE) != 0) {
+        if (*p == '\0')
+            return (size_t) (p - str);
+        ++p;
+    }
+    // aligned word never crosses end of memory region
+    CLI_UINT word;
+    memcpy(&word, p, CLI_UINT_SIZE);
+    while (!CLI_WORD_HAS_ZERO(word)) {
+        p += CLI_UINT_SIZE;
+        memcpy(&word, p, CLI_UINT_SIZE);
+    }
+    while (*p != '\0')
+        ++p;
+    return (size_t) (p - str);
+#else
+    return strlen(str);
+#endif
+}
+
+static bool cliMemEqual(const char *a, const char *b, size_t len) {
+#ifdef CLI_WORD_STRINGS
+    if (((uintptr_t) a % CLI_UINT_SIZE) == ((uintptr_t) b % CLI_UINT_SIZE)) {
+        while (len > 0 && ((uintptr_t) a % CLI_UINT_SIZE) != 0) {
+            if (*a != *b)
+                return false;
+            ++a;
+            ++b;
+            --len;
+        }
+        for (; len >= CLI_UINT_SIZE; len -= CLI_UINT_SIZE) {
+            CLI_UINT wordA;
+            CLI_UINT wordB;
+            memcpy(&wordA, a, CLI_UINT_SIZE);
+            memcpy(&wordB, b, CLI_UINT_SIZE);
+            if (wordA != wordB)
+                return false;
+            a += CLI_UINT_SIZE;
+            b += CLI_UINT_SIZE;
+        }
+    }
+#endif
+    for (size_t i = 0; i < len; ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+static void writeU16(uint8_t *buf, uint16_t value) {
+    buf[0] = (uint8_t) (value & 0xFFu);
+    buf[1] = (uint8_t) (value >> 8);
+}
+
+static uint16_t readU16(const uint8_t *buf) {
+    return (uint16_t) (buf[0] | (buf[1] << 8));
+}
+
+static uint16_t stateChecksum(const uint8_t *data, size_t len) {
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    for (size_t i = 0; i < len; ++i) {
+        sum1 = (uint16_t) ((sum1 + data[i]) % 255);
+        sum2 = (uint16_t) ((sum2 + sum1) % 255);
+    }
+    return (uint16_t) ((sum2 << 8) | sum1);
+}
+
 static uint16_t getTokenPosition(const char *tokenizedStr, uint16_t pos) {
     if (tokenizedStr == NULL || pos == 0)
         return CLI_TOKEN_NPOS;
@@ -1165,3 +4644,222 @@ static uint16_t getTokenPosition(const char *tokenizedStr, uint16_t pos) {
     else
         return CLI_TOKEN_NPOS;
 }
+
+static uint16_t radixTreeNodesCount(uint16_t bindingCount) {
+    // one extra node for root
+    return (uint16_t) (2 * bindingCount + 1);
+}
+
+static bool radixNodeIsTerminal(CliRadixTree *tree, uint16_t node) {
+    const CliRadixNode *n = &tree->nodes[node];
+    return n->binding != CLI_RADIX_NONE && tree->bindings[n->binding].name[n->depth] == '\0';
+}
+
+static uint16_t radixNodeFindChild(CliRadixTree *tree, uint16_t node, char c) {
+    uint16_t depth = tree->nodes[node].depth;
+    uint16_t child = tree->nodes[node].firstChild;
+    while (child != CLI_RADIX_NONE) {
+        if (tree->bindings[tree->nodes[child].binding].name[depth] == c)
+            return child;
+        child = tree->nodes[child].nextSibling;
+    }
+    return CLI_RADIX_NONE;
+}
+
+static void radixNodeAddChild(CliRadixTree *tree, uint16_t node, uint16_t child) {
+    tree->nodes[child].parent = node;
+    tree->nodes[child].nextSibling = tree->nodes[node].firstChild;
+    tree->nodes[node].firstChild = child;
+}
+
+static void radixNodeReplace(CliRadixTree *tree, uint16_t node, uint16_t replacement) {
+    uint16_t *link = &tree->nodes[tree->nodes[node].parent].firstChild;
+    while (*link != node)
+        link = &tree->nodes[*link].nextSibling;
+
+    if (replacement == CLI_RADIX_NONE) {
+        *link = tree->nodes[node].nextSibling;
+        return;
+    }
+    *link = replacement;
+    tree->nodes[replacement].parent = tree->nodes[node].parent;
+    tree->nodes[replacement].nextSibling = tree->nodes[node].nextSibling;
+}
+
+static uint16_t radixNodeAlloc(CliRadixTree *tree) {
+    uint16_t node = tree->freeNodes;
+    if (node != CLI_RADIX_NONE) {
+        tree->freeNodes = tree->nodes[node].nextSibling;
+    } else if (tree->nodesCount < tree->maxNodesCount) {
+        node = tree->nodesCount++;
+    }
+    return node;
+}
+
+static void radixNodeFree(CliRadixTree *tree, uint16_t node) {
+    tree->nodes[node].binding = CLI_RADIX_NONE;
+    tree->nodes[node].nextSibling = tree->freeNodes;
+    tree->freeNodes = node;
+}
+
+static uint16_t radixTreeFindNode(CliRadixTree *tree, const char *str, uint16_t len, bool isPrefix) {
+    uint16_t node = 0;
+    uint16_t pos = 0;
+    while (pos < len) {
+        uint16_t child = radixNodeFindChild(tree, node, str[pos]);
+        if (child == CLI_RADIX_NONE)
+            return CLI_RADIX_NONE;
+
+        // depth of node is the length of its label, so most mismatches are
+        // rejected without comparing chars
+        uint16_t depth = tree->nodes[child].depth;
+        if (depth > len) {
+            if (!isPrefix)
+                return CLI_RADIX_NONE;
+            depth = len;
+        }
+        const char *label = tree->bindings[tree->nodes[child].binding].name;
+        if (!cliMemEqual(&label[pos], &str[pos], (size_t) (depth - pos)))
+            return CLI_RADIX_NONE;
+        pos = depth;
+        node = child;
+    }
+    return node;
+}
+
+static void radixTreeReset(CliRadixTree *tree) {
+    tree->nodes[0].binding = CLI_RADIX_NONE;
+    tree->nodes[0].depth = 0;
+    tree->nodes[0].parent = CLI_RADIX_NONE;
+    tree->nodes[0].firstChild = CLI_RADIX_NONE;
+    tree->nodes[0].nextSibling = CLI_RADIX_NONE;
+    tree->nodesCount = 1;
+    tree->freeNodes = CLI_RADIX_NONE;
+}
+
+static bool radixTreeInsert(CliRadixTree *tree, uint16_t binding) {
+    const char *name = tree->bindings[binding].name;
+    if (name[0] == '\0')
+        return false;
+
+    uint16_t node = 0;
+    uint16_t pos = 0;
+    while (name[pos] != '\0') {
+        uint16_t child = radixNodeFindChild(tree, node, name[pos]);
+
+        if (child == CLI_RADIX_NONE) {
+            // nothing shares remaining part of name, so it becomes a leaf
+            child = radixNodeAlloc(tree);
+            if (child == CLI_RADIX_NONE)
+                return false;
+            tree->nodes[child].binding = binding;
+            tree->nodes[child].depth = (uint16_t) (pos + cliStrLen(&name[pos]));
+            tree->nodes[child].firstChild = CLI_RADIX_NONE;
+            radixNodeAddChild(tree, node, child);
+            return true;
+        }
+
+        const char *label = tree->bindings[tree->nodes[child].binding].name;
+        while (pos < tree->nodes[child].depth && label[pos] == name[pos])
+            ++pos;
+
+        if (pos < tree->nodes[child].depth) {
+            // name diverges from label, so split it at this position
+            uint16_t mid = radixNodeAlloc(tree);
+            if (mid == CLI_RADIX_NONE)
+                return false;
+            tree->nodes[mid].binding = tree->nodes[child].binding;
+            tree->nodes[mid].depth = pos;
+            tree->nodes[mid].firstChild = child;
+            // first char of label is the same, so mid takes place of child
+            radixNodeReplace(tree, child, mid);
+            tree->nodes[child].parent = mid;
+            tree->nodes[child].nextSibling = CLI_RADIX_NONE;
+            child = mid;
+        }
+        node = child;
+    }
+
+    if (radixNodeIsTerminal(tree, node))
+        return false;
+    // name ends at branching node, so this node becomes terminal
+    tree->nodes[node].binding = binding;
+    return true;
+}
+
+static uint16_t radixTreeFind(CliRadixTree *tree, const char *name, uint16_t len) {
+    uint16_t node = radixTreeFindNode(tree, name, len, false);
+    if (node == CLI_RADIX_NONE || !radixNodeIsTerminal(tree, node))
+        return CLI_RADIX_NONE;
+    return tree->nodes[node].binding;
+}
+
+static void radixTreeRemove(CliRadixTree *tree, uint16_t binding) {
+    const char *name = tree->bindings[binding].name;
+    uint16_t node = radixTreeFindNode(tree, name, (uint16_t) cliStrLen(name), false);
+    uint16_t parent = tree->nodes[node].parent;
+
+    if (tree->nodes[node].firstChild == CLI_RADIX_NONE) {
+        radixNodeReplace(tree, node, CLI_RADIX_NONE);
+        radixNodeFree(tree, node);
+        node = parent;
+    } else {
+        // node stays in tree as branching node
+        tree->nodes[node].binding = tree->nodes[tree->nodes[node].firstChild].binding;
+    }
+
+    // node without name ending at it and with single child is merged with it
+    uint16_t child = tree->nodes[node].firstChild;
+    if (node != 0 && !radixNodeIsTerminal(tree, node) &&
+        tree->nodes[child].nextSibling == CLI_RADIX_NONE) {
+        radixNodeReplace(tree, node, child);
+        radixNodeFree(tree, node);
+        node = tree->nodes[child].parent;
+    }
+
+    // labels of nodes on the path might point to removed name
+    for (; node != CLI_RADIX_NONE; node = tree->nodes[node].parent) {
+        if (tree->nodes[node].binding == binding)
+            tree->nodes[node].binding = tree->nodes[tree->nodes[node].firstChild].binding;
+    }
+}
+
+static uint16_t radixTreeFindPrefix(CliRadixTree *tree, const char *prefix) {
+    uint16_t node = radixTreeFindNode(tree, prefix, (uint16_t) cliStrLen(prefix), true);
+    if (node == CLI_RADIX_NONE)
+        return CLI_RADIX_NONE;
+
+    // all candidates share labels until tree branches or some name ends
+    while (!radixNodeIsTerminal(tree, node) &&
+           tree->nodes[node].firstChild != CLI_RADIX_NONE &&
+           tree->nodes[tree->nodes[node].firstChild].nextSibling == CLI_RADIX_NONE) {
+        node = tree->nodes[node].firstChild;
+    }
+    return node;
+}
+
+static uint16_t radixTreeNextTerminal(CliRadixTree *tree, uint16_t subtree, uint16_t node) {
+    if (subtree == CLI_RADIX_NONE)
+        return CLI_RADIX_NONE;
+
+    if (node == CLI_RADIX_NONE) {
+        node = subtree;
+        if (radixNodeIsTerminal(tree, node))
+            return node;
+    }
+
+    // pre-order traversal, parent pointers are used instead of stack
+    while (true) {
+        if (tree->nodes[node].firstChild != CLI_RADIX_NONE) {
+            node = tree->nodes[node].firstChild;
+        } else {
+            while (node != subtree && tree->nodes[node].nextSibling == CLI_RADIX_NONE)
+                node = tree->nodes[node].parent;
+            if (node == subtree)
+                return CLI_RADIX_NONE;
+            node = tree->nodes[node].nextSibling;
+        }
+        if (radixNodeIsTerminal(tree, node))
+            return node;
+    }
+}
@@ -0,0 +1,124 @@
+#!/usr/bin/python3
+"""
+Prints worst-case stack depth of each public function of library.
+Uses call graphs produced by gcc with -fstack-usage -fcallgraph-info=su
+(enable BUILD_STACK_REPORT option in cmake to get them).
+Stack used by callbacks (writeChar, bindings, lock hooks) is not known, so
+it must be added to reported depth of functions that call them.
+Usage: stack-report.py <dir with .ci files or .ci files>...
+"""
+import os
+import re
+import sys
+
+NODE_RE = re.compile(r'node: \{ title: "([^"]*)" label: "([^"]*)"')
+EDGE_RE = re.compile(r'edge: \{ sourcename: "([^"]*)" targetname: "([^"]*)"')
+SIZE_RE = re.compile(r'\\n(\d+) bytes \(([^)]*)\)')
+
+INDIRECT_CALL = '__indirect_call'
+
+
+def find_ci_files(paths):
+    for path in paths:
+        if os.path.isdir(path):
+            for root, _, files in os.walk(path):
+                for name in files:
+                    if name.endswith('.ci'):
+                        yield os.path.join(root, name)
+        else:
+            yield path
+
+
+def parse(files):
+    frames = {}
+    qualifiers = {}
+    calls = {}
+    for file in files:
+        with open(file, 'r') as f:
+            for line in f:
+                node = NODE_RE.search(line)
+                if node:
+                    size = SIZE_RE.search(node.group(2))
+                    if size:
+                        frames[node.group(1)] = int(size.group(1))
+                        qualifiers[node.group(1)] = size.group(2)
+                    continue
+                edge = EDGE_RE.search(line)
+                if edge:
+                    calls.setdefault(edge.group(1), set()).add(edge.group(2))
+    return frames, qualifiers, calls
+
+
+def display_name(title):
+    # static functions are prefixed with file name
+    return title.rsplit(':', 1)[-1]
+
+
+class Analyzer:
+    def __init__(self, frames, qualifiers, calls):
+        self.frames = frames
+        self.qualifiers = qualifiers
+        self.calls = calls
+        self.cache = {}
+
+    def depth(self, function, stack=()):
+        """
+        Returns (depth, path, notes) of deepest call chain from function
+        """
+        if function in self.cache:
+            return self.cache[function]
+        if function in stack:
+            return 0, [], {'recursion'}
+
+        notes = set()
+        frame = self.frames.get(function)
+        if frame is None:
+            if function == INDIRECT_CALL:
+                notes.add('callbacks')
+            else:
+                notes.add('external: ' + display_name(function))
+            return 0, [], notes
+        if self.qualifiers[function] != 'static':
+            notes.add(display_name(function) + ' is ' + self.qualifiers[function])
+
+        worst = (0, [])
+        for callee in sorted(self.calls.get(function, ())):
+            callee_depth, callee_path, callee_notes = self.depth(callee, stack + (function,))
+            notes |= callee_notes
+            if callee_depth > worst[0]:
+                worst = (callee_depth, callee_path)
+
+        result = (frame + worst[0], [display_name(function)] + worst[1], notes)
+        if 'recursion' not in notes:
+            self.cache[function] = result
+        return result
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip())
+        return 1
+
+    frames, qualifiers, calls = parse(find_ci_files(sys.argv[1:]))
+    analyzer = Analyzer(frames, qualifiers, calls)
+
+    public = sorted(f for f in frames if ':' not in f)
+    if not public:
+        print('No call graphs found')
+        return 1
+
+    print('{:<32} {:>6} {:>6}  {}'.format('Function', 'Frame', 'Depth', 'Worst path'))
+    for function in public:
+        depth, path, notes = analyzer.depth(function)
+        print('{:<32} {:>6} {:>6}  {}'.format(function, frames[function], depth, ' -> '.join(path)))
+        external = sorted(n[len('external: '):] for n in notes if n.startswith('external: '))
+        other = sorted(n for n in notes if not n.startswith('external: '))
+        if external:
+            other.append('external: ' + ', '.join(external))
+        if other:
+            print('{:<47}  + {}'.format('', '; '.join(other)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -4,11 +4,16 @@
 #include <stdexcept>
 
 CliBuilder::CliBuilder() {
-    this->config = embeddedCliDefaultConfig();
+    embeddedCliInitDefaultConfig(&this->config);
 }
 
 CliBuilder &CliBuilder::autocomplete(bool enabled) {
-    this->config->enableAutoComplete = enabled;
+    this->config.enableAutoComplete = enabled;
+    return *this;
+}
+
+CliBuilder &CliBuilder::bindingStats(bool enabled) {
+    this->config.enableBindingStats = enabled;
     return *this;
 }
 
@@ -16,22 +21,52 @@ CliWrapper CliBuilder::build() {
     std::optional<std::unique_ptr<CLI_UINT>> buffer = std::nullopt;
 
     if (useStatic) {
-        auto minSize = embeddedCliRequiredSize(this->config);
+        auto minSize = embeddedCliRequiredSize(&this->config);
         auto *buf = new CLI_UINT[BYTES_TO_CLI_UINTS(minSize)];
         buffer = std::optional<std::unique_ptr<CLI_UINT>>{buf};
-        this->config->cliBuffer = buf;
-        this->config->cliBufferSize = minSize;
+        this->config.cliBuffer = buf;
+        this->config.cliBufferSize = minSize;
     }
 
-    EmbeddedCli *cli = embeddedCliNew(this->config);
+    EmbeddedCli *cli = embeddedCliNew(&this->config);
     if (cli == nullptr) {
         throw std::runtime_error("Expected non-null cli pointer");
     }
     return {cli, std::move(buffer)};
 }
 
+CliBuilder &CliBuilder::chaining(bool enabled) {
+    this->config.enableChaining = enabled;
+    return *this;
+}
+
+CliBuilder &CliBuilder::execute(bool enabled) {
+    this->config.enableExecute = enabled;
+    return *this;
+}
+
+CliBuilder &CliBuilder::filterBuffer(uint16_t size) {
+    this->config.filterBufferSize = size;
+    return *this;
+}
+
+CliBuilder &CliBuilder::helpDictionary(const char *const *dictionary) {
+    this->config.helpDictionary = dictionary;
+    return *this;
+}
+
+CliBuilder &CliBuilder::inputReadyTriggers(uint8_t triggers) {
+    this->config.inputReadyTriggers = triggers;
+    return *this;
+}
+
 CliBuilder &CliBuilder::invitation(const char *text) {
-    this->config->invitation = text;
+    this->config.invitation = text;
+    return *this;
+}
+
+CliBuilder &CliBuilder::outputChunkSize(uint16_t size) {
+    this->config.outputChunkSize = size;
     return *this;
 }
 
@@ -39,3 +74,8 @@ CliBuilder &CliBuilder::staticAllocation() {
     this->useStatic = true;
     return *this;
 }
+
+CliBuilder &CliBuilder::watches(uint16_t count) {
+    this->config.maxWatchCount = count;
+    return *this;
+}
@@ -11,14 +11,30 @@ public:
 
     CliBuilder &autocomplete(bool enabled);
 
+    CliBuilder &bindingStats(bool enabled);
+
     CliWrapper build();
 
+    CliBuilder &chaining(bool enabled);
+
+    CliBuilder &execute(bool enabled);
+
+    CliBuilder &filterBuffer(uint16_t size);
+
+    CliBuilder &helpDictionary(const char *const *dictionary);
+
+    CliBuilder &inputReadyTriggers(uint8_t triggers);
+
     CliBuilder &invitation(const char *text);
 
+    CliBuilder &outputChunkSize(uint16_t size);
+
     CliBuilder &staticAllocation();
 
+    CliBuilder &watches(uint16_t count);
+
 private:
-    EmbeddedCliConfig *config;
+    EmbeddedCliConfig config{};
     bool useStatic = false;
 };
 
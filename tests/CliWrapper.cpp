@@ -67,6 +67,21 @@ void CliWrapper::addBinding(const std::string &name,
     }
 }
 
+std::vector<size_t> CliWrapper::getBytesPerKeystroke(const std::vector<std::string> &keys) {
+    std::vector<size_t> bytes;
+    for (auto &key: keys) {
+        markOutput();
+        send(key);
+        process();
+        bytes.push_back(getBytesSinceMark());
+    }
+    return bytes;
+}
+
+size_t CliWrapper::getBytesSinceMark() {
+    return txQueue.size() - outputMark;
+}
+
 std::vector<CliWrapper::Command> &CliWrapper::getCalledBindings() {
     return calledBindings;
 }
@@ -120,6 +135,10 @@ std::vector<CliWrapper::Command> &CliWrapper::getReceivedCommands() {
     return receivedCommands;
 }
 
+void CliWrapper::markOutput() {
+    outputMark = txQueue.size();
+}
+
 void CliWrapper::process() {
     embeddedCliProcess(cli);
 }
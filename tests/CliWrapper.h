@@ -40,6 +40,20 @@ public:
                     const std::optional<std::string> &help = std::nullopt,
                     bool tokenizeArgs = true);
 
+    /**
+     * Sends each key separately (key can be multiple chars, like escape
+     * sequence) and processes it.
+     * @param keys
+     * @return number of bytes output by cli in response to each key
+     */
+    std::vector<size_t> getBytesPerKeystroke(const std::vector<std::string> &keys);
+
+    /**
+     * @return number of bytes output by cli since last call to markOutput
+     * (or since creation)
+     */
+    size_t getBytesSinceMark();
+
     /**
      * Vector of all called bindings
      * @return
@@ -69,6 +83,12 @@ public:
      */
     std::vector<Command> &getReceivedCommands();
 
+    /**
+     * Remember current size of output, so bytes output after it can be
+     * counted with getBytesSinceMark
+     */
+    void markOutput();
+
     /**
      * Prints given text via cli
      * @param text
@@ -128,6 +148,11 @@ private:
      */
     std::vector<char> txQueue;
 
+    /**
+     * Size of txQueue at last call to markOutput
+     */
+    size_t outputMark = 0;
+
     /**
      * All bindings that are registered in cli
      */
@@ -0,0 +1,120 @@
+
+#include "UartLink.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// start bit, 8 data bits and stop bit
+static const uint64_t bitsPerByte = 10;
+
+uint64_t UartLink::Report::latencyPercentile(double p) const {
+    if (latenciesUs.empty())
+        return 0;
+    std::vector<uint64_t> sorted = latenciesUs;
+    std::sort(sorted.begin(), sorted.end());
+    auto rank = (size_t) std::ceil(p / 100.0 * (double) sorted.size());
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+double UartLink::Report::commandsPerSecond() const {
+    if (durationUs == 0)
+        return 0;
+    return (double) commands * 1e6 / (double) durationUs;
+}
+
+UartLink::UartLink(const EmbeddedCliConfig *cliConfig, Config config) : config(config) {
+    if (config.baudRate == 0 || config.txFifoSize == 0 || config.processPeriodUs == 0) {
+        throw std::invalid_argument("Baud rate, FIFO size and process period must not be 0");
+    }
+    byteTimeNs = bitsPerByte * 1000000000ull / config.baudRate;
+
+    cli = embeddedCliNew(cliConfig);
+    if (cli == nullptr) {
+        throw std::runtime_error("Expected non-null cli pointer");
+    }
+    cli->appContext = this;
+    cli->writeChar = [](EmbeddedCli *embeddedCli, char) {
+        ((UartLink *) embeddedCli->appContext)->onWriteChar();
+    };
+    cli->onCommand = [](EmbeddedCli *, CliCommand *) {};
+}
+
+UartLink::~UartLink() {
+    embeddedCliFree(cli);
+}
+
+EmbeddedCli *UartLink::raw() {
+    return cli;
+}
+
+UartLink::Report UartLink::runSession(const std::vector<std::string> &lines) {
+    Report report;
+    uint64_t start = now;
+    size_t txStart = txBytes;
+    uint64_t periodNs = config.processPeriodUs * 1000ull;
+    // process is called on fixed grid (unless previous call took longer)
+    uint64_t nextProcess = now;
+
+    for (auto &line: lines) {
+        std::deque<Key> keys;
+        uint64_t sendTime = now;
+        for (char c: line + "\r") {
+            keys.push_back({c, sendTime, sendTime + byteTimeNs});
+            sendTime += byteTimeNs + config.keyIntervalUs * 1000ull;
+        }
+        report.rxBytes += keys.size();
+
+        while (!keys.empty()) {
+            now = std::max(now, nextProcess);
+
+            std::vector<Key> delivered;
+            while (!keys.empty() && keys.front().arrivedNs <= now) {
+                embeddedCliReceiveChar(cli, keys.front().c);
+                delivered.push_back(keys.front());
+                keys.pop_front();
+            }
+
+            size_t txBefore = txBytes;
+            embeddedCliProcess(cli);
+
+            // terminal has all output when last written byte is transmitted
+            uint64_t doneNs = txBytes > txBefore ? txFifo.back() : now;
+            for (auto &key: delivered) {
+                if (key.c != '\r')
+                    report.latenciesUs.push_back((doneNs - key.sentNs) / 1000);
+            }
+
+            while (nextProcess <= now)
+                nextProcess += periodNs;
+        }
+
+        // wait until output of command is received
+        if (!txFifo.empty())
+            now = std::max(now, txFifo.back());
+        drainTx();
+        ++report.commands;
+    }
+
+    report.durationUs = (now - start) / 1000;
+    report.txBytes = txBytes - txStart;
+    return report;
+}
+
+void UartLink::onWriteChar() {
+    drainTx();
+    if (txFifo.size() == config.txFifoSize) {
+        // device waits until there is space in FIFO
+        now = txFifo.front();
+        txFifo.pop_front();
+    }
+    uint64_t startNs = txFifo.empty() ? now : std::max(now, txFifo.back());
+    txFifo.push_back(startNs + byteTimeNs);
+    ++txBytes;
+}
+
+void UartLink::drainTx() {
+    while (!txFifo.empty() && txFifo.front() <= now) {
+        txFifo.pop_front();
+    }
+}
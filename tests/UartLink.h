@@ -0,0 +1,131 @@
+#ifndef EMBEDDED_CLI_UARTLINK_H
+#define EMBEDDED_CLI_UARTLINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "embedded_cli.h"
+
+/**
+ * Simulates cli that is connected to terminal through serial link (8N1) in
+ * virtual time. Received bytes are passed to cli as soon as they arrive,
+ * embeddedCliProcess is called periodically. Output goes through TX FIFO of
+ * finite size, writeChar stalls device while FIFO is full. Processing itself
+ * takes no time.
+ */
+class UartLink {
+public:
+    struct Config {
+        uint32_t baudRate = 115200;
+
+        /**
+         * Number of bytes that can wait for transmission (including the one
+         * that is being transmitted)
+         */
+        size_t txFifoSize = 16;
+
+        /**
+         * Period of embeddedCliProcess calls
+         */
+        uint32_t processPeriodUs = 1000;
+
+        /**
+         * Pause between keystrokes of terminal. If 0, keys are sent back to
+         * back at link speed (like pasted text)
+         */
+        uint32_t keyIntervalUs = 0;
+    };
+
+    struct Report {
+        /**
+         * Time from start of keystroke transmission until all output in
+         * response to it is received by terminal (line endings are not
+         * counted)
+         */
+        std::vector<uint64_t> latenciesUs;
+
+        uint64_t durationUs = 0;
+
+        size_t commands = 0;
+
+        size_t rxBytes = 0;
+
+        size_t txBytes = 0;
+
+        /**
+         * @param p - percentile in range (0, 100]
+         * @return latency with nearest rank method
+         */
+        uint64_t latencyPercentile(double p) const;
+
+        double commandsPerSecond() const;
+    };
+
+    /**
+     * Creates cli with given config. Bindings can be added through raw(), but
+     * appContext and writeChar must not be changed.
+     * @param cliConfig
+     * @param config
+     */
+    UartLink(const EmbeddedCliConfig *cliConfig, Config config);
+
+    UartLink(const UartLink &) = delete;
+
+    UartLink &operator=(const UartLink &) = delete;
+
+    ~UartLink();
+
+    EmbeddedCli *raw();
+
+    /**
+     * Types each line and waits until it is executed and its output is
+     * received before typing next one
+     * @param lines - commands without line endings
+     * @return statistics of this session
+     */
+    Report runSession(const std::vector<std::string> &lines);
+
+private:
+    struct Key {
+        char c;
+        /**
+         * Time when transmission of key starts
+         */
+        uint64_t sentNs;
+        /**
+         * Time when key is received by device
+         */
+        uint64_t arrivedNs;
+    };
+
+    EmbeddedCli *cli;
+
+    Config config;
+
+    uint64_t byteTimeNs;
+
+    /**
+     * Current time of device
+     */
+    uint64_t now = 0;
+
+    /**
+     * Finish times of bytes in TX FIFO
+     */
+    std::deque<uint64_t> txFifo;
+
+    size_t txBytes = 0;
+
+    void onWriteChar();
+
+    /**
+     * Remove bytes that are already transmitted from FIFO
+     */
+    void drainTx();
+};
+
+
+#endif //EMBEDDED_CLI_UARTLINK_H
@@ -0,0 +1,104 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+// malloc and free are wrapped at link time (see tests/CMakeLists.txt), so
+// all allocations made by library can be counted
+#ifdef CLI_TESTS_WRAP_MALLOC
+
+#include <cstdlib>
+
+static bool countAllocations = false;
+static size_t allocations = 0;
+static size_t frees = 0;
+
+extern "C" {
+void *__real_malloc(size_t size);
+
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+    if (countAllocations)
+        ++allocations;
+    return __real_malloc(size);
+}
+
+void __wrap_free(void *ptr) {
+    if (countAllocations && ptr != nullptr)
+        ++frees;
+    __real_free(ptr);
+}
+}
+
+static void runSession(CliWrapper &cli) {
+    cli.addBinding("get", "Get value");
+    cli.addBinding("set", "Set value");
+    cli.process();
+
+    cli.sendLine("get a b");
+    cli.sendLine("set \"a b\" c");
+    cli.send("g\t\x1B[A\x1B[B\b\b");
+    cli.sendLine("help");
+    cli.sendLine("help get");
+    cli.sendLine("unknown");
+    cli.sendLine("stats");
+    cli.sendLine("get a; set b && help || get | grep a | count");
+    cli.process();
+
+    cli.print("message");
+    embeddedCliExecute(cli.raw(), "get x", CLI_EXECUTE_OUTPUT | CLI_EXECUTE_HISTORY);
+    const char script[] = "get 1\n# comment\nset 2\n";
+    embeddedCliRunScript(cli.raw(), script, sizeof(script), nullptr);
+    embeddedCliRemoveBinding(cli.raw(), "set");
+    cli.addBinding("set", "Set value again");
+    cli.process();
+}
+
+TEST_CASE("CLI. Allocations", "[cli]") {
+    allocations = 0;
+    frees = 0;
+
+    SECTION("Only single allocation is made with dynamic allocation") {
+        countAllocations = true;
+        CliWrapper *cli = new CliWrapper(CliBuilder()
+                                                 .bindingStats(true)
+                                                 .chaining(true)
+                                                 .execute(true)
+                                                 .filterBuffer(32)
+                                                 .watches(1)
+                                                 .build());
+        countAllocations = false;
+        REQUIRE(allocations == 1);
+
+        countAllocations = true;
+        runSession(*cli);
+        countAllocations = false;
+        REQUIRE(allocations == 1);
+        REQUIRE(frees == 0);
+
+        countAllocations = true;
+        delete cli;
+        countAllocations = false;
+        REQUIRE(frees == 1);
+    }
+
+    SECTION("No allocations are made with static allocation") {
+        CliWrapper cli = CliBuilder()
+                .bindingStats(true)
+                .chaining(true)
+                .execute(true)
+                .filterBuffer(32)
+                .watches(1)
+                .staticAllocation()
+                .build();
+
+        countAllocations = true;
+        runSession(cli);
+        countAllocations = false;
+        REQUIRE(allocations == 0);
+        REQUIRE(frees == 0);
+    }
+}
+
+#endif
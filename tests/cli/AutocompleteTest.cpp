@@ -101,6 +101,31 @@ TEST_CASE("CLI. Autocomplete enabled", "[cli]") {
         REQUIRE(displayed.cursorColumn == 5);
     }
 
+    SECTION("Autocomplete when candidates branch after common prefix") {
+        cli.addBinding("reset-second-a");
+        cli.addBinding("reset-second-b");
+
+        cli.send("reset-s\t");
+        cli.process();
+
+        auto displayed = cli.getDisplay();
+
+        REQUIRE(displayed.lines.size() == 1);
+        REQUIRE(displayed.lines[0] == "> reset-second");
+        REQUIRE(displayed.cursorColumn == 14);
+
+        cli.send("\t");
+        cli.process();
+
+        displayed = cli.getDisplay();
+
+        REQUIRE(displayed.lines.size() == 4);
+        REQUIRE(displayed.lines[0] == "reset-second");
+        REQUIRE(displayed.lines[1] == "reset-second-a");
+        REQUIRE(displayed.lines[2] == "reset-second-b");
+        REQUIRE(displayed.lines[3] == "> reset-second");
+    }
+
     SECTION("Autocomplete when no candidates") {
         cli.send("m\t");
         cli.process();
@@ -148,6 +148,38 @@ TEST_CASE("CLI. Base tests", "[cli]") {
             REQUIRE(cmds.back().args.size() == 1);
             REQUIRE(cmds.back().args[0] == "led");
         }
+
+        SECTION("Command with prefix of other binding") {
+            cli.addBinding("get-led");
+            cli.addBinding("get");
+            cli.addBinding("get-adc");
+
+            cli.sendLine("get-led 1");
+            cli.sendLine("get 2");
+            cli.sendLine("get-a 3");
+            cli.process();
+
+            auto &cmds = cli.getCalledBindings();
+            REQUIRE(cmds.size() == 2);
+            REQUIRE(cmds[0].name == "get-led");
+            REQUIRE(cmds[1].name == "get");
+            REQUIRE(commands.size() == 1);
+            REQUIRE(commands.back().name == "get-a");
+        }
+
+        SECTION("Duplicate binding is not added") {
+            CliCommandBinding binding = {
+                    .name = "get",
+                    .help = nullptr,
+                    .tokenizeArgs = false,
+                    .context = nullptr,
+                    .binding = nullptr
+            };
+            REQUIRE(embeddedCliAddBinding(cli.raw(), binding));
+            REQUIRE_FALSE(embeddedCliAddBinding(cli.raw(), binding));
+            binding.name = "help";
+            REQUIRE_FALSE(embeddedCliAddBinding(cli.raw(), binding));
+        }
     }
 
     SECTION("Escape sequences") {
@@ -0,0 +1,168 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <map>
+#include <random>
+
+
+TEST_CASE("CLI. Bindings removal", "[cli]") {
+    CliWrapper cli = CliBuilder().build();
+
+    auto &commands = cli.getReceivedCommands();
+    auto &bindings = cli.getCalledBindings();
+
+    cli.addBinding("get");
+    cli.addBinding("get-led");
+    cli.addBinding("get-adc");
+
+    SECTION("Removed binding is not called") {
+        REQUIRE(embeddedCliRemoveBinding(cli.raw(), "get-led"));
+
+        cli.sendLine("get-led");
+        cli.sendLine("get-adc");
+        cli.process();
+
+        REQUIRE(commands.size() == 1);
+        REQUIRE(commands.back().name == "get-led");
+        REQUIRE(bindings.size() == 1);
+        REQUIRE(bindings.back().name == "get-adc");
+    }
+
+    SECTION("Removing unknown binding") {
+        REQUIRE_FALSE(embeddedCliRemoveBinding(cli.raw(), "get-"));
+        REQUIRE_FALSE(embeddedCliRemoveBinding(cli.raw(), "set"));
+        REQUIRE_FALSE(embeddedCliRemoveBinding(cli.raw(), nullptr));
+    }
+
+    SECTION("Removed binding is not autocompleted") {
+        REQUIRE(embeddedCliRemoveBinding(cli.raw(), "get"));
+        REQUIRE(embeddedCliRemoveBinding(cli.raw(), "get-adc"));
+
+        cli.send("g\t");
+        cli.process();
+
+        auto displayed = cli.getDisplay();
+
+        REQUIRE(displayed.lines.size() == 1);
+        REQUIRE(displayed.lines[0] == "> get-led");
+    }
+
+    SECTION("Removed binding is not in help") {
+        REQUIRE(embeddedCliRemoveBinding(cli.raw(), "get-adc"));
+
+        cli.sendLine("help");
+        cli.process();
+
+        REQUIRE(cli.getRawOutput().find("get-led") != std::string::npos);
+        REQUIRE(cli.getRawOutput().find("get-adc") == std::string::npos);
+    }
+
+    SECTION("Slot of removed binding is reused") {
+        // help and 3 bindings are added, so 5 more can be added
+        REQUIRE(embeddedCliRemoveBinding(cli.raw(), "get"));
+        for (int i = 0; i < 6; ++i) {
+            cli.addBinding("set" + std::to_string(i));
+        }
+
+        cli.sendLine("set5");
+        cli.sendLine("get-led");
+        cli.process();
+
+        REQUIRE(commands.empty());
+        REQUIRE(bindings.size() == 2);
+        REQUIRE(bindings[0].name == "set5");
+        REQUIRE(bindings[1].name == "get-led");
+    }
+
+    SECTION("Slots of removed bindings are reused in reverse order") {
+        uint16_t getId = embeddedCliGetBindingId(cli.raw(), "get");
+        uint16_t adcId = embeddedCliGetBindingId(cli.raw(), "get-adc");
+        uint16_t ledId = embeddedCliGetBindingId(cli.raw(), "get-led");
+        REQUIRE(embeddedCliRemoveBinding(cli.raw(), "get"));
+        REQUIRE(embeddedCliRemoveBinding(cli.raw(), "get-adc"));
+
+        cli.addBinding("set1");
+        cli.addBinding("set2");
+        cli.addBinding("set3");
+
+        REQUIRE(embeddedCliGetBindingId(cli.raw(), "set1") == adcId);
+        REQUIRE(embeddedCliGetBindingId(cli.raw(), "set2") == getId);
+        REQUIRE(embeddedCliGetBindingId(cli.raw(), "set3") > ledId);
+        REQUIRE(embeddedCliGetBindingId(cli.raw(), "get-led") == ledId);
+    }
+
+    SECTION("Replace binding") {
+        CliCommandBinding binding = {
+                .name = "get-led",
+                .help = nullptr,
+                .tokenizeArgs = false,
+                .context = nullptr,
+                .binding = nullptr
+        };
+        REQUIRE(embeddedCliReplaceBinding(cli.raw(), binding));
+        binding.name = "set";
+        REQUIRE_FALSE(embeddedCliReplaceBinding(cli.raw(), binding));
+
+        cli.sendLine("get-led 1");
+        cli.process();
+
+        REQUIRE(bindings.empty());
+        REQUIRE(commands.size() == 1);
+        REQUIRE(commands.back().name == "get-led");
+    }
+}
+
+TEST_CASE("CLI. Random bindings changes", "[cli]") {
+    EmbeddedCliConfig *config = embeddedCliDefaultConfig();
+    config->maxBindingCount = 16;
+    CliWrapper cli(embeddedCliNew(config), std::nullopt);
+
+    // short names from small alphabet, so they share a lot of prefixes
+    std::vector<std::string> names;
+    for (const char *a: {"a", "ab", "b"}) {
+        for (const char *b: {"", "a", "ab", "ba"}) {
+            for (const char *c: {"", "b", "ba"}) {
+                names.push_back(std::string(a) + b + c);
+            }
+        }
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    std::map<std::string, bool> added;
+    std::vector<CliCommandBinding> storage;
+    std::mt19937 rng(42);
+
+    auto binding = [](EmbeddedCli *, char *, void *context) {
+        auto *called = (bool *) context;
+        *called = true;
+    };
+    bool called = false;
+
+    for (int step = 0; step < 2000; ++step) {
+        const std::string &name = names[rng() % names.size()];
+        if (added.count(name) != 0) {
+            REQUIRE(embeddedCliRemoveBinding(cli.raw(), name.c_str()));
+            added.erase(name);
+        } else if (added.size() < 16) {
+            REQUIRE(embeddedCliAddBinding(cli.raw(), {
+                    .name = name.c_str(),
+                    .help = nullptr,
+                    .tokenizeArgs = false,
+                    .context = &called,
+                    .binding = binding
+            }));
+            added[name] = true;
+        }
+
+        for (const auto &n: names) {
+            called = false;
+            // trailing space disables autocompletion of command
+            cli.sendLine(n + " ");
+            cli.process();
+            REQUIRE(called == (added.count(n) != 0));
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+
+TEST_CASE("CLI. Chaining", "[cli]") {
+    CliWrapper cli = CliBuilder()
+            .chaining(true)
+            .build();
+
+    auto &commands = cli.getReceivedCommands();
+    auto &bindings = cli.getCalledBindings();
+
+    cli.addBinding("get");
+    cli.addBinding("set");
+    cli.addBinding("raw", std::nullopt, false);
+    embeddedCliAddBinding(cli.raw(), {
+            .name = "fail",
+            .help = nullptr,
+            .tokenizeArgs = false,
+            .context = nullptr,
+            .binding = [](EmbeddedCli *c, char *args, void *context) {
+                embeddedCliCommandFailed(c);
+            }
+    });
+
+    SECTION("Commands separated by semicolon") {
+        cli.sendLine("get a;set b c ; get;;");
+        cli.process();
+
+        REQUIRE(commands.empty());
+        REQUIRE(bindings.size() == 3);
+        REQUIRE(bindings[0].name == "get");
+        REQUIRE(bindings[0].args.size() == 1);
+        REQUIRE(bindings[0].args[0] == "a");
+        REQUIRE(bindings[1].name == "set");
+        REQUIRE(bindings[1].args.size() == 2);
+        REQUIRE(bindings[1].args[0] == "b");
+        REQUIRE(bindings[1].args[1] == "c");
+        REQUIRE(bindings[2].name == "get");
+        REQUIRE(bindings[2].args.empty());
+    }
+
+    SECTION("Commands after failure are skipped with &&") {
+        cli.sendLine("get && fail && set; get 2");
+        cli.process();
+
+        REQUIRE(bindings.size() == 2);
+        REQUIRE(bindings[0].name == "get");
+        REQUIRE(bindings[1].name == "get");
+        REQUIRE(bindings[1].args[0] == "2");
+    }
+
+    SECTION("Commands after success are skipped with ||") {
+        cli.sendLine("fail || get 1 || set && get 2");
+        cli.process();
+
+        REQUIRE(bindings.size() == 2);
+        REQUIRE(bindings[0].args[0] == "1");
+        REQUIRE(bindings[1].args[0] == "2");
+    }
+
+    SECTION("Quoted and escaped separators are not split") {
+        cli.sendLine("get \"a;b\" c\\;d&&raw x&y \"|| z\"");
+        cli.process();
+
+        REQUIRE(bindings.size() == 2);
+        REQUIRE(bindings[0].args.size() == 2);
+        REQUIRE(bindings[0].args[0] == "a;b");
+        REQUIRE(bindings[0].args[1] == "c;d");
+        REQUIRE(bindings[1].name == "raw");
+        REQUIRE(bindings[1].args[0] == "x&y \"|| z\"");
+    }
+
+    SECTION("Unknown commands are passed to onCommand") {
+        cli.sendLine("unknown 1;get");
+        cli.process();
+
+        REQUIRE(commands.size() == 1);
+        REQUIRE(commands[0].name == "unknown");
+        REQUIRE(bindings.size() == 1);
+    }
+
+    SECTION("Whole line is put to history") {
+        cli.sendLine("get;set");
+        cli.send("\x1B[A");
+        cli.process();
+
+        REQUIRE(cli.getDisplay().lines.back() == "> get;set");
+    }
+}
+
+TEST_CASE("CLI. Chaining disabled", "[cli]") {
+    CliWrapper cli = CliBuilder().build();
+
+    cli.addBinding("get");
+
+    cli.sendLine("get a;get b");
+    cli.process();
+
+    REQUIRE(cli.getCalledBindings().size() == 1);
+    REQUIRE(cli.getCalledBindings()[0].args[0] == "a;get");
+}
@@ -0,0 +1,105 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include "embedded_cli.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+
+static embedded_cli::Event transferDone;
+
+static embedded_cli::Task onRead(embedded_cli::Coroutines &co, char *args) {
+    // args are valid only before first suspension
+    std::string name = embeddedCliGetToken(args, 1);
+    co.print(("start " + name).c_str());
+    co_await co.wait(transferDone);
+    co.print(("done " + name).c_str());
+}
+
+static embedded_cli::Task onCount(embedded_cli::Coroutines &co, char *) {
+    for (char i = '1'; i <= '3'; ++i) {
+        co_await co.nextProcess();
+        char str[] = {i, '\0'};
+        co.print(str);
+    }
+}
+
+TEST_CASE("CLI. Coroutine bindings", "[cli]") {
+    CliWrapper cli = CliBuilder().build();
+    embedded_cli::CoroutinePool<256, 2> coroutines(cli.raw());
+
+    transferDone.reset();
+    REQUIRE(coroutines.addBinding("read", "Read value", true, onRead));
+    REQUIRE(coroutines.addBinding("count", nullptr, false, onCount));
+
+    SECTION("Coroutine is resumed when event is set") {
+        cli.sendLine("read adc");
+        cli.process();
+        coroutines.process();
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines[1] == "start adc");
+        REQUIRE(lines.back() == ">");
+        REQUIRE(coroutines.activeCount() == 1);
+
+        // input is processed while coroutine waits
+        cli.send("he");
+        cli.process();
+        transferDone.set();
+        coroutines.process();
+
+        lines = cli.getDisplay().lines;
+        REQUIRE(lines[lines.size() - 2] == "done adc");
+        REQUIRE(lines.back() == "> help");
+        REQUIRE(coroutines.activeCount() == 0);
+    }
+
+    SECTION("Already set event doesn't suspend") {
+        transferDone.set();
+        cli.sendLine("read x");
+        cli.process();
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines[2] == "done x");
+        REQUIRE(coroutines.activeCount() == 0);
+        REQUIRE_FALSE(transferDone.isSet());
+    }
+
+    SECTION("Coroutine is resumed once per process") {
+        cli.sendLine("count");
+        cli.process();
+        coroutines.process();
+        coroutines.process();
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines.size() == 4);
+        REQUIRE(lines[1] == "1");
+        REQUIRE(lines[2] == "2");
+
+        coroutines.process();
+        coroutines.process();
+        REQUIRE(cli.getDisplay().lines.size() == 5);
+        REQUIRE(coroutines.activeCount() == 0);
+    }
+
+    SECTION("Number of frames is limited") {
+        cli.sendLine("count");
+        cli.sendLine("count");
+        cli.sendLine("count");
+        cli.process();
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines[3] == "Not enough memory to start command");
+        REQUIRE(coroutines.activeCount() == 2);
+
+        for (int i = 0; i < 3; ++i)
+            coroutines.process();
+        REQUIRE(coroutines.activeCount() == 0);
+
+        cli.sendLine("count");
+        cli.process();
+        REQUIRE(coroutines.activeCount() == 1);
+    }
+}
@@ -0,0 +1,128 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+
+TEST_CASE("CLI. Execute", "[cli]") {
+    CliWrapper cli = CliBuilder().execute(true).build();
+
+    auto &commands = cli.getReceivedCommands();
+    auto &bindings = cli.getCalledBindings();
+
+    cli.addBinding("get");
+    cli.process();
+
+    SECTION("Execute binding") {
+        REQUIRE(embeddedCliExecute(cli.raw(), "get led 1", 0));
+
+        REQUIRE(commands.empty());
+        REQUIRE(bindings.size() == 1);
+        REQUIRE(bindings.back().name == "get");
+        REQUIRE(bindings.back().args.size() == 2);
+        REQUIRE(bindings.back().args[0] == "led");
+        REQUIRE(bindings.back().args[1] == "1");
+    }
+
+    SECTION("Execute unknown command") {
+        REQUIRE(embeddedCliExecute(cli.raw(), "set led", 0));
+
+        REQUIRE(commands.size() == 1);
+        REQUIRE(commands.back().name == "set");
+        REQUIRE(cli.getRawOutput() == "> ");
+    }
+
+    SECTION("Output is discarded without flag") {
+        cli.raw()->onCommand = nullptr;
+
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "set led", 0));
+        REQUIRE(cli.getRawOutput() == "> ");
+    }
+
+    SECTION("Output is printed with flag and current input is kept") {
+        cli.raw()->onCommand = nullptr;
+        cli.send("ge");
+        cli.process();
+
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "set led", CLI_EXECUTE_OUTPUT));
+
+        auto displayed = cli.getDisplay();
+
+        REQUIRE(displayed.lines.size() == 2);
+        REQUIRE(displayed.lines[0].find("Unknown command") != std::string::npos);
+        REQUIRE(displayed.lines[1] == "> get");
+        REQUIRE(displayed.cursorColumn == 4);
+
+        cli.sendLine("");
+        cli.process();
+        REQUIRE(bindings.size() == 1);
+        REQUIRE(bindings.back().name == "get");
+    }
+
+    SECTION("Command is not put to history without flag") {
+        embeddedCliExecute(cli.raw(), "get 1", 0);
+        embeddedCliExecute(cli.raw(), "get 2", CLI_EXECUTE_HISTORY);
+
+        cli.send("\x1B[A\x1B[A");
+        cli.process();
+
+        auto displayed = cli.getDisplay();
+
+        REQUIRE(displayed.lines.size() == 1);
+        REQUIRE(displayed.lines[0] == "> get 2");
+    }
+
+    SECTION("Too long command is not executed") {
+        std::string line = "get " + std::string(100, 'a');
+
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), line.c_str(), 0));
+        REQUIRE(bindings.empty());
+    }
+
+    SECTION("Failure is reported") {
+        embeddedCliAddBinding(cli.raw(), {
+                .name = "fail",
+                .help = nullptr,
+                .tokenizeArgs = false,
+                .context = nullptr,
+                .binding = [](EmbeddedCli *c, char *args, void *context) {
+                    embeddedCliCommandFailed(c);
+                }
+        });
+
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "fail", 0));
+        REQUIRE(embeddedCliExecute(cli.raw(), "get", 0));
+    }
+}
+
+TEST_CASE("CLI. Execute when disabled", "[cli]") {
+    CliWrapper cli = CliBuilder().build();
+
+    auto &bindings = cli.getCalledBindings();
+
+    cli.addBinding("get");
+    cli.process();
+
+    SECTION("Command is not executed") {
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "get", 0));
+        REQUIRE(bindings.empty());
+    }
+
+    SECTION("Script is not executed") {
+        std::string script = "get\nget 1\n";
+
+        auto result = embeddedCliRunScript(cli.raw(), script.c_str(), script.size(), nullptr);
+
+        REQUIRE(result.linesExecuted == 0);
+        REQUIRE(bindings.empty());
+    }
+
+    SECTION("Exec buffer is not allocated") {
+        EmbeddedCliConfig config;
+        embeddedCliInitDefaultConfig(&config);
+        uint16_t size = embeddedCliRequiredSize(&config);
+        config.enableExecute = true;
+
+        REQUIRE(embeddedCliRequiredSize(&config) >= size + config.cmdBufferSize);
+    }
+}
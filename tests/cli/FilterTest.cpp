@@ -0,0 +1,124 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+
+TEST_CASE("CLI. Output filters", "[cli]") {
+    CliWrapper cli = CliBuilder()
+            .filterBuffer(16)
+            .chaining(true)
+            .build();
+
+    auto &bindings = cli.getCalledBindings();
+    cli.addBinding("get");
+
+    // prints lines "line-1", "line-2", ... "line-5"
+    embeddedCliAddBinding(cli.raw(), {
+            .name = "lines",
+            .help = nullptr,
+            .tokenizeArgs = false,
+            .context = nullptr,
+            .binding = [](EmbeddedCli *c, char *args, void *context) {
+                std::string line = "line-0";
+                for (char i = '1'; i <= '5'; ++i) {
+                    line.back() = i;
+                    embeddedCliPrint(c, line.c_str());
+                }
+            }
+    });
+    cli.process();
+
+    SECTION("Grep") {
+        cli.sendLine("lines | grep 3");
+        cli.process();
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines.size() == 3);
+        REQUIRE(lines[0] == "> lines | grep 3");
+        REQUIRE(lines[1] == "line-3");
+        REQUIRE(lines[2] == ">");
+    }
+
+    SECTION("Head") {
+        cli.sendLine("lines | head 2");
+        cli.process();
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines.size() == 4);
+        REQUIRE(lines[1] == "line-1");
+        REQUIRE(lines[2] == "line-2");
+    }
+
+    SECTION("Count") {
+        cli.sendLine("lines | count");
+        cli.process();
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines.size() == 3);
+        REQUIRE(lines[1] == "5");
+    }
+
+    SECTION("Multiple filters") {
+        cli.sendLine("lines|grep \"line\" | head 4|grep -| count");
+        cli.process();
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines.size() == 3);
+        REQUIRE(lines[1] == "4");
+    }
+
+    SECTION("Filters with chaining") {
+        cli.sendLine("lines | head 1 && lines | grep 5 || get");
+        cli.process();
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines.size() == 4);
+        REQUIRE(lines[1] == "line-1");
+        REQUIRE(lines[2] == "line-5");
+        REQUIRE(bindings.empty());
+    }
+
+    SECTION("Quoted pipe is passed to command") {
+        cli.sendLine("get \"a | b\" | count");
+        cli.process();
+
+        REQUIRE(bindings.size() == 1);
+        REQUIRE(bindings[0].args.size() == 1);
+        REQUIRE(bindings[0].args[0] == "a | b");
+        REQUIRE(cli.getDisplay().lines[1] == "0");
+    }
+
+    SECTION("Long lines are truncated") {
+        cli.sendLine("help | grep help");
+        cli.process();
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines.size() == 3);
+        REQUIRE(lines[1] == " * help");
+    }
+
+    SECTION("Invalid filters") {
+        for (auto cmd: {"lines | grep", "lines | head x", "lines | count 1", "lines | tail 1", "lines |",
+                        "lines | count | count | count | count | count"}) {
+            cli.sendLine(cmd);
+            cli.process();
+            auto lines = cli.getDisplay().lines;
+            REQUIRE(lines[lines.size() - 2] ==
+                    "Invalid filter. Available filters: grep <pattern>, head <lines>, count");
+        }
+    }
+}
+
+TEST_CASE("CLI. Output filters are disabled by default", "[cli]") {
+    CliWrapper cli = CliBuilder().build();
+
+    cli.addBinding("get");
+
+    cli.sendLine("get a | grep b");
+    cli.process();
+
+    REQUIRE(cli.getCalledBindings().size() == 1);
+    REQUIRE(cli.getCalledBindings()[0].args.size() == 4);
+    REQUIRE(cli.getCalledBindings()[0].args[1] == "|");
+}
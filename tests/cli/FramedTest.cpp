@@ -0,0 +1,391 @@
+#include "embedded_cli.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace {
+    struct FramedContext {
+        std::string output;
+        uint32_t calls = 0;
+    };
+
+    uint16_t crc16(const std::string &data) {
+        uint16_t crc = 0xFFFF;
+        for (char c: data) {
+            crc ^= (uint16_t) ((uint8_t) c << 8);
+            for (int i = 0; i < 8; ++i)
+                crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+        }
+        return crc;
+    }
+
+    std::string cobsEncode(const std::string &data) {
+        std::string encoded;
+        std::string block;
+        for (char c: data) {
+            if (c == '\0') {
+                encoded += (char) (block.size() + 1);
+                encoded += block;
+                block.clear();
+                continue;
+            }
+            block += c;
+            if (block.size() == 254) {
+                encoded += (char) 0xFF;
+                encoded += block;
+                block.clear();
+            }
+        }
+        encoded += (char) (block.size() + 1);
+        encoded += block;
+        encoded += '\0';
+        return encoded;
+    }
+
+    std::string cobsDecode(const std::string &frame) {
+        std::string decoded;
+        size_t i = 0;
+        // skip leading delimiter
+        while (i < frame.size() && frame[i] == '\0')
+            ++i;
+        while (i < frame.size() && frame[i] != '\0') {
+            auto code = (uint8_t) frame[i++];
+            for (uint8_t j = 1; j < code; ++j)
+                decoded += frame[i++];
+            if (code != 0xFF && frame[i] != '\0')
+                decoded += '\0';
+        }
+        return decoded;
+    }
+
+    std::string request(uint16_t id, const std::string &args) {
+        std::string data;
+        data += (char) (id & 0xFF);
+        data += (char) (id >> 8);
+        data += args;
+        uint16_t crc = crc16(data);
+        data += (char) (crc & 0xFF);
+        data += (char) (crc >> 8);
+        return cobsEncode(data);
+    }
+
+    struct Response {
+        uint16_t id;
+        std::string output;
+        uint8_t status;
+        bool crcValid;
+    };
+
+    Response parseResponse(const std::string &frame) {
+        std::string data = cobsDecode(frame);
+        REQUIRE(data.size() >= 5);
+        Response r;
+        r.id = (uint16_t) ((uint8_t) data[0] | ((uint8_t) data[1] << 8));
+        r.output = data.substr(2, data.size() - 5);
+        r.status = (uint8_t) data[data.size() - 3];
+        uint16_t crc = (uint16_t) ((uint8_t) data[data.size() - 2] | ((uint8_t) data[data.size() - 1] << 8));
+        r.crcValid = crc == crc16(data.substr(0, data.size() - 2));
+        return r;
+    }
+
+    void send(EmbeddedCli *cli, const std::string &bytes) {
+        for (char c: bytes) {
+            embeddedCliReceiveChar(cli, c);
+        }
+        embeddedCliProcess(cli);
+    }
+}
+
+TEST_CASE("CLI. Framed mode", "[cli]") {
+    EmbeddedCliConfig config;
+    embeddedCliInitDefaultConfig(&config);
+    config.rxBufferSize = 128;
+    config.frameBufferSize = 64;
+    EmbeddedCli *cli = embeddedCliNew(&config);
+    REQUIRE(cli != nullptr);
+
+    FramedContext context;
+    cli->appContext = &context;
+    cli->writeChar = [](EmbeddedCli *c, char ch) {
+        ((FramedContext *) c->appContext)->output += ch;
+    };
+
+    // prints all tokens joined with ',' and fails without args
+    embeddedCliAddBinding(cli, {"join", nullptr, true, nullptr, [](EmbeddedCli *c, char *args, void *) {
+        auto *ctx = (FramedContext *) c->appContext;
+        ++ctx->calls;
+        if (args == nullptr) {
+            embeddedCliCommandFailed(c);
+            return;
+        }
+        for (uint16_t i = 1; i <= embeddedCliGetTokenCount(args); ++i) {
+            if (i > 1)
+                c->writeChar(c, ',');
+            for (const char *t = embeddedCliGetToken(args, i); *t != '\0'; ++t)
+                c->writeChar(c, *t);
+        }
+    }});
+    // prints 600 chars with zeros in between
+    embeddedCliAddBinding(cli, {"long", nullptr, false, nullptr, [](EmbeddedCli *c, char *, void *) {
+        for (int i = 0; i < 600; ++i)
+            c->writeChar(c, (char) (i % 300 == 299 ? '\0' : 'a' + i % 26));
+    }});
+    embeddedCliAddBinding(cli, {"print", nullptr, false, nullptr, [](EmbeddedCli *c, char *, void *) {
+        embeddedCliPrint(c, "msg");
+    }});
+    embeddedCliAddBinding(cli, {"text", nullptr, false, nullptr, [](EmbeddedCli *c, char *, void *) {
+        embeddedCliSetFramedMode(c, false);
+    }});
+    embeddedCliAddBinding(cli, {"binary", nullptr, false, nullptr, [](EmbeddedCli *c, char *, void *) {
+        embeddedCliSetFramedMode(c, true);
+    }});
+
+    uint16_t joinId = embeddedCliGetBindingId(cli, "join");
+    REQUIRE(joinId != CLI_BINDING_ID_NONE);
+    REQUIRE(embeddedCliGetBindingId(cli, "unknown") == CLI_BINDING_ID_NONE);
+
+    embeddedCliProcess(cli);
+    REQUIRE(embeddedCliSetFramedMode(cli, true));
+    context.output.clear();
+
+    SECTION("Binding receives args and output is returned in frame") {
+        send(cli, std::string(1, '\0') + request(joinId, std::string("12\0-5\0x", 7)));
+
+        REQUIRE(context.output.front() == '\0');
+        REQUIRE(context.output.back() == '\0');
+        Response r = parseResponse(context.output);
+        REQUIRE(r.crcValid);
+        REQUIRE(r.id == joinId);
+        REQUIRE(r.status == CLI_FRAME_STATUS_OK);
+        REQUIRE(r.output == "12,-5,x");
+    }
+
+    SECTION("Failed binding") {
+        send(cli, std::string(1, '\0') + request(joinId, ""));
+
+        Response r = parseResponse(context.output);
+        REQUIRE(r.status == CLI_FRAME_STATUS_FAILED);
+        REQUIRE(context.calls == 1);
+    }
+
+    SECTION("Unknown binding") {
+        send(cli, std::string(1, '\0') + request(1000, ""));
+
+        Response r = parseResponse(context.output);
+        REQUIRE(r.id == 1000);
+        REQUIRE(r.status == CLI_FRAME_STATUS_UNKNOWN);
+    }
+
+    SECTION("Invalid CRC and bytes before first delimiter") {
+        std::string frame = request(joinId, "1");
+        frame[2] ^= 0x01;
+        send(cli, "join 1\r\n" + std::string(1, '\0') + frame);
+
+        Response r = parseResponse(context.output);
+        REQUIRE(r.crcValid);
+        REQUIRE(r.id == CLI_BINDING_ID_NONE);
+        REQUIRE(r.status == CLI_FRAME_STATUS_INVALID);
+        REQUIRE(context.calls == 0);
+    }
+
+    SECTION("Too long request") {
+        send(cli, std::string(1, '\0') + request(joinId, std::string(100, 'a')));
+
+        Response r = parseResponse(context.output);
+        REQUIRE(r.status == CLI_FRAME_STATUS_INVALID);
+        REQUIRE(context.calls == 0);
+    }
+
+    SECTION("Long output with zeros") {
+        send(cli, std::string(1, '\0') + request(embeddedCliGetBindingId(cli, "long"), ""));
+
+        REQUIRE(context.output.find('\0', 1) == context.output.size() - 1);
+        Response r = parseResponse(context.output);
+        REQUIRE(r.crcValid);
+        REQUIRE(r.output.size() == 600);
+        REQUIRE(r.output[299] == '\0');
+        REQUIRE(r.output[300] == 'o');
+    }
+
+    SECTION("Print from binding is written to response") {
+        send(cli, std::string(1, '\0') + request(embeddedCliGetBindingId(cli, "print"), ""));
+
+        Response r = parseResponse(context.output);
+        REQUIRE(r.crcValid);
+        REQUIRE(r.status == CLI_FRAME_STATUS_OK);
+        REQUIRE(r.output == "msg\r\n");
+    }
+
+    SECTION("Print outside of binding is sent as message") {
+        embeddedCliPrint(cli, "log");
+
+        REQUIRE(context.output.front() == '\0');
+        REQUIRE(context.output.find('\0', 1) == context.output.size() - 1);
+        Response r = parseResponse(context.output);
+        REQUIRE(r.crcValid);
+        REQUIRE(r.id == CLI_BINDING_ID_NONE);
+        REQUIRE(r.status == CLI_FRAME_STATUS_MESSAGE);
+        REQUIRE(r.output == "log");
+    }
+
+    SECTION("Switching between modes") {
+        send(cli, std::string(1, '\0') + request(embeddedCliGetBindingId(cli, "text"), ""));
+        REQUIRE(parseResponse(context.output).status == CLI_FRAME_STATUS_OK);
+
+        context.output.clear();
+        send(cli, "");
+        REQUIRE(context.output == "> ");
+
+        send(cli, "join a b\r\n");
+        REQUIRE(context.output.find("a,b") != std::string::npos);
+        REQUIRE(context.calls == 1);
+
+        context.output.clear();
+        send(cli, "binary\r\n");
+        send(cli, std::string(1, '\0') + request(joinId, "c"));
+        REQUIRE(context.calls == 2);
+        REQUIRE(context.output.find("\r\n> ") == std::string::npos);
+    }
+
+    embeddedCliFree(cli);
+}
+
+TEST_CASE("CLI. Watch can't be started in framed mode", "[cli]") {
+    EmbeddedCliConfig config;
+    embeddedCliInitDefaultConfig(&config);
+    config.frameBufferSize = 64;
+    config.maxWatchCount = 1;
+    EmbeddedCli *cli = embeddedCliNew(&config);
+
+    FramedContext context;
+    cli->appContext = &context;
+    cli->writeChar = [](EmbeddedCli *c, char ch) {
+        ((FramedContext *) c->appContext)->output += ch;
+    };
+    static uint32_t currentTime = 0;
+    cli->getTime = [](EmbeddedCli *) {
+        return currentTime;
+    };
+    embeddedCliAddBinding(cli, {"get", nullptr, false, nullptr, [](EmbeddedCli *c, char *, void *) {
+        ++((FramedContext *) c->appContext)->calls;
+        c->writeChar(c, 'o');
+        c->writeChar(c, 'k');
+    }});
+
+    embeddedCliProcess(cli);
+    REQUIRE(embeddedCliSetFramedMode(cli, true));
+    context.output.clear();
+
+    uint16_t watchId = embeddedCliGetBindingId(cli, "watch");
+    REQUIRE(watchId != CLI_BINDING_ID_NONE);
+    send(cli, std::string(1, '\0') + request(watchId, std::string("100\0get\0", 8)));
+
+    Response r = parseResponse(context.output);
+    REQUIRE(r.crcValid);
+    REQUIRE(r.status == CLI_FRAME_STATUS_UNKNOWN);
+
+    // nothing is written between frames
+    context.output.clear();
+    for (int i = 0; i < 5; ++i) {
+        currentTime += 100;
+        embeddedCliProcess(cli);
+    }
+    REQUIRE(context.output.empty());
+    REQUIRE(context.calls == 0);
+
+    embeddedCliFree(cli);
+}
+
+TEST_CASE("CLI. Frame delimiter triggers input ready notification", "[cli]") {
+    EmbeddedCliConfig config;
+    embeddedCliInitDefaultConfig(&config);
+    config.frameBufferSize = 64;
+    config.inputReadyTriggers = CLI_INPUT_READY_LINE_END | CLI_INPUT_READY_ESCAPE | CLI_INPUT_READY_TAB;
+    EmbeddedCli *cli = embeddedCliNew(&config);
+
+    FramedContext context;
+    cli->appContext = &context;
+    cli->writeChar = [](EmbeddedCli *c, char ch) {
+        ((FramedContext *) c->appContext)->output += ch;
+    };
+    static int readyCount;
+    readyCount = 0;
+    cli->onInputReady = [](EmbeddedCli *) {
+        ++readyCount;
+    };
+    embeddedCliAddBinding(cli, {"get", nullptr, false, nullptr, [](EmbeddedCli *c, char *, void *) {
+        ++((FramedContext *) c->appContext)->calls;
+    }});
+    embeddedCliProcess(cli);
+    REQUIRE(embeddedCliSetFramedMode(cli, true));
+    embeddedCliReceiveChar(cli, '\0');
+    embeddedCliProcess(cli);
+    readyCount = 0;
+
+    // payload contains bytes that look like line end, tab and escape sequence
+    std::string frame = request(embeddedCliGetBindingId(cli, "get"), "\r\t\x1B[A\n");
+    for (size_t i = 0; i + 1 < frame.size(); ++i)
+        embeddedCliReceiveChar(cli, frame[i]);
+    REQUIRE(readyCount == 0);
+
+    embeddedCliReceiveChar(cli, frame.back());
+    REQUIRE(readyCount == 1);
+
+    embeddedCliProcess(cli);
+    REQUIRE(context.calls == 1);
+
+    embeddedCliFree(cli);
+}
+
+TEST_CASE("CLI. Framed mode is not available without buffer", "[cli]") {
+    EmbeddedCli *cli = embeddedCliNewDefault();
+
+    REQUIRE_FALSE(embeddedCliSetFramedMode(cli, true));
+
+    embeddedCliFree(cli);
+}
+
+TEST_CASE("CLI. Framed mode throughput", "[.][bench][framed]") {
+    EmbeddedCliConfig config;
+    embeddedCliInitDefaultConfig(&config);
+    config.rxBufferSize = 64;
+    config.frameBufferSize = 64;
+    EmbeddedCli *cli = embeddedCliNew(&config);
+    static size_t written;
+    cli->writeChar = [](EmbeddedCli *, char) {
+        ++written;
+    };
+    embeddedCliAddBinding(cli, {"set-reg", nullptr, true, nullptr, [](EmbeddedCli *, char *, void *) {}});
+    embeddedCliProcess(cli);
+
+    const int commands = 100000;
+    std::string text = "set-reg 1024 65535\r\n";
+    std::string frame = request(embeddedCliGetBindingId(cli, "set-reg"), std::string("1024\0" "65535", 10));
+
+    auto run = [&](const std::string &bytes) {
+        written = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < commands; ++i) {
+            for (char c: bytes)
+                embeddedCliReceiveChar(cli, c);
+            embeddedCliProcess(cli);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    double textTime = run(text);
+    size_t textWritten = written;
+    embeddedCliSetFramedMode(cli, true);
+    embeddedCliReceiveChar(cli, '\0');
+    double framedTime = run(frame);
+
+    printf("text:   %zu bytes in, %zu bytes out, %.0f commands/s\n", text.size(), textWritten / commands,
+           commands / textTime);
+    printf("framed: %zu bytes in, %zu bytes out, %.0f commands/s\n", frame.size(), written / commands,
+           commands / framedTime);
+
+    embeddedCliFree(cli);
+}
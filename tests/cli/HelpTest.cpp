@@ -75,3 +75,82 @@ TEST_CASE("CLI. Help", "[cli]") {
         REQUIRE(displayed.cursorColumn == 2);
     }
 }
+
+TEST_CASE("CLI. Help in chunks", "[cli]") {
+    CliWrapper cli = CliBuilder().execute(true).outputChunkSize(8).build();
+    CliWrapper reference = CliBuilder().build();
+
+    for (auto *c: {&cli, &reference}) {
+        c->addBinding("get", "Get specific parameter");
+        c->addBinding("set", "Set specific parameter");
+        c->addBinding("reset");
+        c->process();
+    }
+
+    SECTION("Output is split between calls") {
+        cli.send("help");
+        cli.process();
+        reference.sendLine("help");
+        reference.process();
+
+        cli.send("\r\n");
+        size_t calls = 0;
+        bool pending = true;
+        while (pending) {
+            cli.markOutput();
+            pending = embeddedCliProcess(cli.raw());
+            if (calls > 0)
+                REQUIRE(cli.getBytesSinceMark() <= 8 + 2);
+            ++calls;
+        }
+
+        auto displayed = cli.getDisplay();
+        auto expected = reference.getDisplay();
+
+        REQUIRE(calls > 5);
+        REQUIRE(displayed.lines == expected.lines);
+        REQUIRE(displayed.cursorColumn == expected.cursorColumn);
+    }
+
+    SECTION("Any key cancels output") {
+        cli.sendLine("help");
+        cli.process();
+        cli.send("x");
+        REQUIRE_FALSE(embeddedCliProcess(cli.raw()));
+
+        auto displayed = cli.getDisplay();
+
+        REQUIRE(cli.getRawOutput().find("reset") == std::string::npos);
+        REQUIRE(displayed.lines.back() == ">");
+        REQUIRE(displayed.cursorColumn == 2);
+    }
+
+    SECTION("Executed help is written at once") {
+        embeddedCliExecute(cli.raw(), "help", CLI_EXECUTE_OUTPUT);
+
+        REQUIRE(cli.getRawOutput().find("reset") != std::string::npos);
+    }
+}
+
+TEST_CASE("CLI. Compressed help", "[cli]") {
+    static const char *const dictionary[] = {"et ", " parameter"};
+    CliWrapper cli = CliBuilder().helpDictionary(dictionary).build();
+
+    cli.addBinding("get", "\x01G\x80specific\x81");
+    cli.addBinding("set", "Set specific parameter");
+
+    SECTION("Compressed help is expanded") {
+        cli.sendLine("help get");
+        cli.process();
+
+        REQUIRE(cli.getRawOutput().find("\tGet specific parameter\r\n") != std::string::npos);
+    }
+
+    SECTION("Plain help is printed as is") {
+        cli.sendLine("help");
+        cli.process();
+
+        REQUIRE(cli.getRawOutput().find("\tGet specific parameter\r\n") != std::string::npos);
+        REQUIRE(cli.getRawOutput().find("\tSet specific parameter\r\n") != std::string::npos);
+    }
+}
@@ -0,0 +1,128 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+
+static int readyCount = 0;
+
+static void onInputReady(EmbeddedCli *) {
+    ++readyCount;
+}
+
+TEST_CASE("CLI. Input ready notification", "[cli]") {
+    readyCount = 0;
+
+    SECTION("All chars trigger notification by default") {
+        CliWrapper cli = CliBuilder().build();
+        cli.raw()->onInputReady = onInputReady;
+
+        cli.send("get");
+        REQUIRE(readyCount == 3);
+    }
+
+    SECTION("Only selected chars trigger notification") {
+        CliWrapper cli = CliBuilder()
+                .inputReadyTriggers(CLI_INPUT_READY_LINE_END | CLI_INPUT_READY_TAB)
+                .build();
+        cli.raw()->onInputReady = onInputReady;
+        cli.addBinding("get");
+
+        cli.send("ge");
+        REQUIRE(readyCount == 0);
+
+        cli.send("\t");
+        REQUIRE(readyCount == 1);
+
+        cli.sendLine(" a");
+        REQUIRE(readyCount == 3);
+
+        cli.process();
+        REQUIRE(cli.getCalledBindings().size() == 1);
+        REQUIRE(cli.getCalledBindings().back().name == "get");
+    }
+
+    SECTION("Escape sequence triggers notification only when it is finished") {
+        CliWrapper cli = CliBuilder()
+                .inputReadyTriggers(CLI_INPUT_READY_ESCAPE)
+                .build();
+        cli.raw()->onInputReady = onInputReady;
+
+        cli.send("\x1B[");
+        REQUIRE(readyCount == 0);
+
+        cli.send("A");
+        REQUIRE(readyCount == 1);
+
+        cli.send("A");
+        REQUIRE(readyCount == 1);
+    }
+
+    SECTION("Overflow always triggers notification") {
+        CliWrapper cli = CliBuilder()
+                .inputReadyTriggers(CLI_INPUT_READY_LINE_END)
+                .build();
+        cli.raw()->onInputReady = onInputReady;
+
+        cli.send(std::string(64, 'a'));
+        REQUIRE(readyCount == 1);
+    }
+}
+
+TEST_CASE("CLI. Process reports pending work", "[cli]") {
+    static uint32_t currentTime;
+    currentTime = 0;
+    CliWrapper cli = CliBuilder()
+            .watches(2)
+            .execute(true)
+            .build();
+    cli.raw()->getTime = [](EmbeddedCli *) {
+        return currentTime;
+    };
+    cli.addBinding("get");
+
+    uint32_t wakeUp = 0;
+    REQUIRE_FALSE(embeddedCliProcess(cli.raw()));
+    REQUIRE_FALSE(embeddedCliGetNextWatchTime(cli.raw(), &wakeUp));
+
+    SECTION("No work after all chars are processed") {
+        cli.sendLine("get");
+        REQUIRE_FALSE(embeddedCliProcess(cli.raw()));
+        REQUIRE(cli.getCalledBindings().size() == 1);
+    }
+
+    SECTION("Watch is pending work only when it is late") {
+        cli.sendLine("watch 100 get");
+        REQUIRE_FALSE(embeddedCliProcess(cli.raw()));
+        REQUIRE(cli.getCalledBindings().size() == 1);
+        REQUIRE(embeddedCliGetNextWatchTime(cli.raw(), &wakeUp));
+        REQUIRE(wakeUp == 100);
+
+        currentTime = 100;
+        REQUIRE_FALSE(embeddedCliProcess(cli.raw()));
+        REQUIRE(cli.getCalledBindings().size() == 2);
+        REQUIRE(embeddedCliGetNextWatchTime(cli.raw(), &wakeUp));
+        REQUIRE(wakeUp == 200);
+
+        cli.send("q");
+        REQUIRE_FALSE(embeddedCliProcess(cli.raw()));
+        REQUIRE_FALSE(embeddedCliGetNextWatchTime(cli.raw(), &wakeUp));
+    }
+
+    SECTION("Next watch time is the earliest deadline") {
+        REQUIRE(embeddedCliExecute(cli.raw(), "watch 300 get", 0));
+        currentTime = 50;
+        REQUIRE(embeddedCliExecute(cli.raw(), "watch 100 get", 0));
+        REQUIRE_FALSE(embeddedCliProcess(cli.raw()));
+        REQUIRE(embeddedCliGetNextWatchTime(cli.raw(), &wakeUp));
+        REQUIRE(wakeUp == 150);
+    }
+
+    SECTION("Deadline is found across timer overflow") {
+        currentTime = UINT32_MAX - 10;
+        cli.sendLine("watch 100 get");
+        REQUIRE_FALSE(embeddedCliProcess(cli.raw()));
+        REQUIRE(embeddedCliGetNextWatchTime(cli.raw(), &wakeUp));
+        REQUIRE(wakeUp == 89);
+    }
+}
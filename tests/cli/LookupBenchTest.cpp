@@ -0,0 +1,71 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Benchmarks of name matching paths (binding lookup, autocompletion and
+// history). Hidden by default, run with "[bench]" tag.
+
+template<typename F>
+static double measureNs(size_t iterations, F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        f(i);
+    }
+    auto duration = std::chrono::steady_clock::now() - start;
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / (double) iterations;
+}
+
+TEST_CASE("CLI. Lookup benchmark", "[.][bench][lookup]") {
+    const size_t bindingCount = 150;
+
+    EmbeddedCliConfig config;
+    embeddedCliInitDefaultConfig(&config);
+    config.maxBindingCount = bindingCount;
+    config.cmdBufferSize = 128;
+    config.historyBufferSize = 2048;
+    config.enableExecute = true;
+    EmbeddedCli *cli = embeddedCliNew(&config);
+    REQUIRE(cli != nullptr);
+    cli->writeChar = [](EmbeddedCli *, char) {};
+
+    // names share long prefixes, like in real command sets
+    std::vector<std::string> names;
+    for (size_t i = 0; i < bindingCount; ++i) {
+        names.push_back("sensor-" + std::string(i % 2 == 0 ? "temperature-" : "pressure-") + std::to_string(i));
+    }
+    for (auto &name: names) {
+        REQUIRE(embeddedCliAddBinding(cli, {name.c_str(), "Read sensor value", false, nullptr,
+                                            [](EmbeddedCli *, char *, void *) {}}));
+    }
+    embeddedCliProcess(cli);
+
+    double lookup = measureNs(100000, [&](size_t i) {
+        embeddedCliExecute(cli, names[i % bindingCount].c_str(), 0);
+    });
+
+    double typing = measureNs(2000, [&](size_t i) {
+        for (char c: names[i % bindingCount]) {
+            embeddedCliReceiveChar(cli, c);
+            embeddedCliProcess(cli);
+        }
+        embeddedCliReceiveChar(cli, '\r');
+        embeddedCliProcess(cli);
+    });
+
+    // all commands are in history, so each one is removed before put
+    double history = measureNs(20000, [&](size_t i) {
+        embeddedCliExecute(cli, names[i % 40].c_str(), CLI_EXECUTE_HISTORY);
+    });
+
+    std::printf("%-32s %10.1f ns\n", "binding lookup", lookup);
+    std::printf("%-32s %10.1f ns\n", "typed command (autocompletion)", typing);
+    std::printf("%-32s %10.1f ns\n", "command with history", history);
+
+    embeddedCliFree(cli);
+}
@@ -0,0 +1,265 @@
+#include "embedded_cli.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+    struct MuxContext {
+        std::string stream;
+        std::string rawInput;
+        std::vector<std::string> commands;
+    };
+
+    struct Frame {
+        uint8_t channel;
+        std::string payload;
+    };
+
+    std::string cobsEncode(const std::string &data) {
+        std::string encoded;
+        std::string block;
+        for (char c: data) {
+            if (c == '\0') {
+                encoded += (char) (block.size() + 1);
+                encoded += block;
+                block.clear();
+                continue;
+            }
+            block += c;
+            if (block.size() == 254) {
+                encoded += (char) 0xFF;
+                encoded += block;
+                block.clear();
+            }
+        }
+        encoded += (char) (block.size() + 1);
+        encoded += block;
+        encoded += '\0';
+        return encoded;
+    }
+
+    std::string cobsDecode(const std::string &data) {
+        std::string decoded;
+        size_t i = 0;
+        while (i < data.size()) {
+            auto code = (uint8_t) data[i++];
+            for (uint8_t j = 1; j < code && i < data.size(); ++j)
+                decoded += data[i++];
+            if (code != 0xFF && i < data.size())
+                decoded += '\0';
+        }
+        return decoded;
+    }
+
+    // host side demux, same as lib/cli-demux.py
+    std::vector<Frame> demux(const std::string &stream) {
+        std::vector<Frame> frames;
+        // everything before first delimiter is discarded
+        size_t start = stream.find('\0');
+        while (start != std::string::npos) {
+            size_t end = stream.find('\0', start + 1);
+            if (end == std::string::npos)
+                break;
+            std::string data = cobsDecode(stream.substr(start + 1, end - start - 1));
+            if (!data.empty() && ((uint8_t) data[0] & 0xF0) == CLI_MUX_TAG)
+                frames.push_back({(uint8_t) (data[0] & 0x0F), data.substr(1)});
+            start = end;
+        }
+        return frames;
+    }
+
+    std::string channelOutput(const std::string &stream, uint8_t channel) {
+        std::string output;
+        for (auto &frame: demux(stream)) {
+            if (frame.channel == channel)
+                output += frame.payload;
+        }
+        return output;
+    }
+
+    std::string frame(uint8_t channel, const std::string &payload) {
+        return cobsEncode((char) (CLI_MUX_TAG | channel) + payload);
+    }
+
+    const std::string delimiter(1, '\0');
+
+    void receive(EmbeddedCliMux *mux, const std::string &bytes) {
+        for (char c: bytes) {
+            embeddedCliMuxReceiveChar(mux, c);
+        }
+    }
+
+    void onCommand(EmbeddedCli *cli, CliCommand *command) {
+        auto *ctx = (MuxContext *) cli->appContext;
+        ctx->commands.push_back(command->name);
+        embeddedCliPrint(cli, command->name);
+    }
+}
+
+TEST_CASE("CLI. Mux", "[cli]") {
+    EmbeddedCliMuxConfig config;
+    embeddedCliMuxInitDefaultConfig(&config);
+    config.channelCount = 3;
+    config.txBufferSize = 32;
+    config.maxPayloadSize = 8;
+    EmbeddedCliMux *mux = embeddedCliMuxNew(&config);
+    REQUIRE(mux != nullptr);
+
+    MuxContext context;
+    mux->appContext = &context;
+    mux->write = [](EmbeddedCliMux *m, const char *data, uint16_t size) {
+        ((MuxContext *) m->appContext)->stream.append(data, size);
+    };
+    mux->onInput = [](EmbeddedCliMux *m, uint8_t channel, char c) {
+        REQUIRE(channel == 1);
+        ((MuxContext *) m->appContext)->rawInput += c;
+    };
+
+    // console on channel 0, log on channel 1, machine channel on 2
+    EmbeddedCli *console = embeddedCliNewDefault();
+    EmbeddedCli *machine = embeddedCliNewDefault();
+    MuxContext consoleContext, machineContext;
+    console->appContext = &consoleContext;
+    machine->appContext = &machineContext;
+    console->onCommand = onCommand;
+    machine->onCommand = onCommand;
+    REQUIRE(embeddedCliMuxAttach(mux, 0, console));
+    REQUIRE(embeddedCliMuxAttach(mux, 2, machine));
+    REQUIRE_FALSE(embeddedCliMuxAttach(mux, 3, machine));
+
+    embeddedCliMuxProcess(mux);
+    REQUIRE(channelOutput(context.stream, 0) == "> ");
+    REQUIRE(channelOutput(context.stream, 2) == "> ");
+    REQUIRE(context.stream.front() == '\0');
+    // host stays synchronized, since each frame ends with delimiter
+    context.stream = delimiter;
+
+    SECTION("Input is routed by channel") {
+        receive(mux, delimiter + frame(2, "get\r\n") + frame(1, "raw") + frame(0, "set\r\n"));
+        embeddedCliMuxProcess(mux);
+
+        REQUIRE(machineContext.commands == std::vector<std::string>{"get"});
+        REQUIRE(consoleContext.commands == std::vector<std::string>{"set"});
+        REQUIRE(context.rawInput == "raw");
+        REQUIRE(channelOutput(context.stream, 2).find("get\r\n> ") != std::string::npos);
+        REQUIRE(channelOutput(context.stream, 0).find("set\r\n> ") != std::string::npos);
+    }
+
+    SECTION("Bytes before first delimiter and unknown channels are skipped") {
+        receive(mux, std::string("\x01noise") + frame(0, "xyz\r\n") + frame(0, "abc\r\n") + frame(5, "x"));
+        embeddedCliMuxProcess(mux);
+
+        REQUIRE(consoleContext.commands == std::vector<std::string>{"abc"});
+    }
+
+    SECTION("Stream is synchronized again after lost byte") {
+        std::string damaged = frame(0, "get\r\n");
+        damaged.erase(1, 1);
+        receive(mux, delimiter + damaged + frame(0, "set\r\n"));
+        embeddedCliMuxProcess(mux);
+
+        REQUIRE(consoleContext.commands == std::vector<std::string>{"set"});
+    }
+
+    SECTION("Zeros in payload are encoded") {
+        std::string log("a\0\0b\0", 5);
+        embeddedCliMuxWrite(mux, 1, log.c_str(), (uint16_t) log.size());
+        embeddedCliMuxProcess(mux);
+
+        REQUIRE(context.stream.back() == '\0');
+        REQUIRE(std::count(context.stream.begin(), context.stream.end(), '\0') == 2);
+        REQUIRE(channelOutput(context.stream, 1) == log);
+    }
+
+    SECTION("Channels take turns") {
+        std::string log(24, 'l');
+        embeddedCliMuxWrite(mux, 1, log.c_str(), (uint16_t) log.size());
+        receive(mux, delimiter + frame(0, "first-command\r\n"));
+        embeddedCliMuxProcess(mux);
+
+        auto frames = demux(context.stream);
+        REQUIRE(frames.size() >= 6);
+        for (size_t i = 0; i < 6; ++i) {
+            REQUIRE(frames[i].payload.size() <= 8);
+        }
+        // console and log frames alternate until log is written
+        REQUIRE(frames[0].channel != frames[1].channel);
+        REQUIRE(frames[2].channel != frames[3].channel);
+        REQUIRE(frames[4].channel != frames[5].channel);
+        REQUIRE(channelOutput(context.stream, 1) == log);
+    }
+
+    SECTION("Full buffer is written immediately") {
+        std::string log;
+        for (int i = 0; i < 200; ++i)
+            log += (char) ('a' + i % 26);
+        embeddedCliMuxWrite(mux, 1, log.c_str(), (uint16_t) log.size());
+        REQUIRE(channelOutput(context.stream, 1).size() >= 200 - 32);
+
+        embeddedCliMuxProcess(mux);
+        REQUIRE(channelOutput(context.stream, 1) == log);
+    }
+
+    embeddedCliFree(console);
+    embeddedCliFree(machine);
+    embeddedCliMuxFree(mux);
+}
+
+TEST_CASE("CLI. Mux frames with long payload", "[cli]") {
+    EmbeddedCliMuxConfig config;
+    embeddedCliMuxInitDefaultConfig(&config);
+    config.channelCount = 1;
+    config.txBufferSize = 600;
+    config.maxPayloadSize = 255;
+    EmbeddedCliMux *mux = embeddedCliMuxNew(&config);
+
+    MuxContext context;
+    mux->appContext = &context;
+    mux->write = [](EmbeddedCliMux *m, const char *data, uint16_t size) {
+        ((MuxContext *) m->appContext)->stream.append(data, size);
+    };
+
+    // payloads longer than single COBS block, with and without zeros
+    std::string log;
+    for (int i = 0; i < 600; ++i)
+        log += (char) (i < 300 ? 'a' + i % 26 : (i % 100 == 0 ? '\0' : 'x'));
+    embeddedCliMuxWrite(mux, 0, log.c_str(), (uint16_t) log.size());
+    embeddedCliMuxProcess(mux);
+
+    auto frames = demux(context.stream);
+    REQUIRE(frames.size() == 3);
+    REQUIRE(frames[0].payload.size() == 255);
+    REQUIRE(channelOutput(context.stream, 0) == log);
+
+    // mux decodes frames written by other mux
+    mux->onInput = [](EmbeddedCliMux *m, uint8_t, char c) {
+        ((MuxContext *) m->appContext)->rawInput += c;
+    };
+    receive(mux, context.stream);
+    REQUIRE(context.rawInput == log);
+
+    embeddedCliMuxFree(mux);
+}
+
+TEST_CASE("CLI. Mux static allocation", "[cli]") {
+    EmbeddedCliMuxConfig config;
+    embeddedCliMuxInitDefaultConfig(&config);
+    uint16_t size = embeddedCliMuxRequiredSize(&config);
+    std::vector<CLI_UINT> buffer(BYTES_TO_CLI_UINTS(size));
+
+    config.muxBuffer = buffer.data();
+    config.muxBufferSize = (uint16_t) (size - 1);
+    REQUIRE(embeddedCliMuxNew(&config) == nullptr);
+
+    config.muxBufferSize = size;
+    EmbeddedCliMux *mux = embeddedCliMuxNew(&config);
+    REQUIRE(mux != nullptr);
+    embeddedCliMuxFree(mux);
+
+    config.channelCount = CLI_MUX_MAX_CHANNELS + 1;
+    REQUIRE(embeddedCliMuxNew(&config) == nullptr);
+}
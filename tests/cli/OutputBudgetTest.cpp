@@ -0,0 +1,91 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+// Budgets are exact numbers of bytes that are sent over UART now. Any redraw
+// regression increases traffic and fails these tests. If output is reduced,
+// update budgets to new values.
+
+TEST_CASE("CLI. Output budget", "[cli][budget]") {
+    CliWrapper cli = CliBuilder()
+            .autocomplete(false)
+            .build();
+    cli.addBinding("get", "Get value");
+    cli.addBinding("set", "Set value");
+    cli.process();
+
+    SECTION("Typing") {
+        REQUIRE(cli.getBytesPerKeystroke({"g", "e", "t", " ", "a"}) == std::vector<size_t>{1, 1, 1, 1, 1});
+    }
+
+    SECTION("Backspace") {
+        cli.send("get");
+        cli.process();
+        REQUIRE(cli.getBytesPerKeystroke({"\b", "\b", "\b", "\b"}) == std::vector<size_t>{3, 3, 3, 0});
+    }
+
+    SECTION("Tab") {
+        cli.send("g");
+        cli.process();
+        REQUIRE(cli.getBytesPerKeystroke({"\t", "\t"}) == std::vector<size_t>{3, 0});
+    }
+
+    SECTION("Enter") {
+        cli.send("get a");
+        cli.process();
+        REQUIRE(cli.getBytesPerKeystroke({"\r\n", "\r\n"}) == std::vector<size_t>{4, 0});
+    }
+
+    SECTION("History navigation") {
+        cli.sendLine("get a");
+        cli.sendLine("set b c");
+        cli.process();
+        REQUIRE(cli.getBytesPerKeystroke({"\x1B[A", "\x1B[A", "\x1B[A", "\x1B[B", "\x1B[B"}) ==
+              std::vector<size_t>{13, 18, 0, 18, 13});
+    }
+
+    SECTION("Print") {
+        cli.markOutput();
+        cli.print("hello");
+        REQUIRE(cli.getBytesSinceMark() == 13);
+
+        cli.send("get a");
+        cli.process();
+        cli.markOutput();
+        cli.print("hello");
+        REQUIRE(cli.getBytesSinceMark() == 18);
+    }
+
+    SECTION("Help") {
+        cli.send("help");
+        cli.process();
+        REQUIRE(cli.getBytesPerKeystroke({"\r\n"}) == std::vector<size_t>{79});
+    }
+}
+
+TEST_CASE("CLI. Output budget with live autocompletion", "[cli][budget]") {
+    CliWrapper cli = CliBuilder()
+            .autocomplete(true)
+            .build();
+    cli.addBinding("get", "Get value");
+    cli.addBinding("get-led", "Get led");
+    cli.addBinding("set", "Set value");
+    cli.process();
+
+    SECTION("Typing") {
+        REQUIRE(cli.getBytesPerKeystroke({"g", "e", "t", "-", " ", "a"}) == std::vector<size_t>{7, 7, 7, 11, 11, 10});
+    }
+
+    SECTION("Backspace") {
+        cli.send("get-l");
+        cli.process();
+        REQUIRE(cli.getBytesPerKeystroke({"\b", "\b", "\b", "\b", "\b"}) == std::vector<size_t>{13, 13, 9, 9, 9});
+    }
+
+    SECTION("Tab") {
+        cli.send("s");
+        cli.process();
+        REQUIRE(cli.getBytesPerKeystroke({"\t", "\t"}) == std::vector<size_t>{10, 7});
+    }
+}
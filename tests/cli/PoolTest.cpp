@@ -0,0 +1,92 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include "embedded_cli_pool.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <future>
+#include <string>
+
+
+// wait until all submitted commands are printed
+static void finish(CliWrapper &cli, embedded_cli::WorkerPool &pool) {
+    while (pool.pendingCount() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        cli.process();
+        pool.process();
+    }
+}
+
+TEST_CASE("CLI. Worker pool", "[cli]") {
+    CliWrapper cli = CliBuilder().build();
+    cli.addBinding("get");
+
+    embedded_cli::WorkerPool pool(cli.raw(), 2);
+
+    // slow command waits until test releases it
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    REQUIRE(pool.addBinding("slow", "Slow command", true, [released](embedded_cli::PoolOutput &out, char *args) {
+        released.wait();
+        out.print("slow " + std::string(embeddedCliGetToken(args, 1)));
+        out.print("slow done");
+    }));
+    REQUIRE(pool.addBinding("fast", nullptr, false, [](embedded_cli::PoolOutput &out, char *args) {
+        out.print(args != nullptr ? args : "fast");
+    }));
+
+    SECTION("Slow command doesn't block other commands") {
+        cli.sendLine("slow 1");
+        cli.sendLine("get");
+        cli.send("ge");
+        cli.process();
+        pool.process();
+
+        // typing and other bindings are processed while slow command runs
+        REQUIRE(cli.getCalledBindings().size() == 1);
+        REQUIRE(cli.getDisplay().lines.back() == "> get");
+        REQUIRE(pool.pendingCount() == 1);
+
+        release.set_value();
+        finish(cli, pool);
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines[lines.size() - 3] == "slow 1");
+        REQUIRE(lines[lines.size() - 2] == "slow done");
+        REQUIRE(lines.back() == "> get");
+    }
+
+    SECTION("Output is printed in submission order") {
+        cli.sendLine("slow 1");
+        cli.sendLine("fast a b");
+        cli.sendLine("fast");
+        cli.process();
+
+        // fast commands finish first, but wait for slow one
+        for (int i = 0; i < 20; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            pool.process();
+        }
+        REQUIRE(pool.pendingCount() == 3);
+
+        release.set_value();
+        finish(cli, pool);
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines.size() == 8);
+        REQUIRE(lines[3] == "slow 1");
+        REQUIRE(lines[4] == "slow done");
+        REQUIRE(lines[5] == "a b");
+        REQUIRE(lines[6] == "fast");
+    }
+
+    SECTION("Help is available for offloaded bindings") {
+        release.set_value();
+        cli.sendLine("help slow");
+        cli.process();
+
+        REQUIRE(cli.getDisplay().lines[2] == "\tSlow command");
+    }
+}
@@ -0,0 +1,74 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+
+TEST_CASE("CLI. Receive line", "[cli]") {
+    CliWrapper cli = CliBuilder().build();
+
+    auto &commands = cli.getReceivedCommands();
+    auto &bindings = cli.getCalledBindings();
+
+    cli.addBinding("get");
+    cli.process();
+    cli.markOutput();
+
+    SECTION("Line is executed with echo") {
+        std::string line = "get led 1\r\n";
+        REQUIRE(embeddedCliReceiveLine(cli.raw(), line.data(), line.size(), true));
+
+        REQUIRE(bindings.size() == 1);
+        REQUIRE(bindings.back().name == "get");
+        REQUIRE(bindings.back().args.size() == 2);
+        REQUIRE(bindings.back().args[1] == "1");
+        // echo is written at once without redraws
+        REQUIRE(cli.getRawOutput() == "> get led 1\r\n> ");
+    }
+
+    SECTION("Line is executed without echo") {
+        std::string line = "set led";
+        REQUIRE(embeddedCliReceiveLine(cli.raw(), line.data(), line.size(), false));
+
+        REQUIRE(commands.size() == 1);
+        REQUIRE(commands.back().name == "set");
+        REQUIRE(cli.getRawOutput() == "> > ");
+    }
+
+    SECTION("Line is not autocompleted and is put to history") {
+        std::string line = "ge";
+        embeddedCliReceiveLine(cli.raw(), line.data(), line.size(), false);
+        REQUIRE(bindings.empty());
+        REQUIRE(commands.back().name == "ge");
+
+        cli.send("\x1B[A");
+        cli.process();
+        // rest of "get" is shown only as live autocompletion
+        auto displayed = cli.getDisplay();
+        REQUIRE(displayed.lines.back() == "> get");
+        REQUIRE(displayed.cursorColumn == 4);
+    }
+
+    SECTION("Typed input is replaced") {
+        cli.send("set");
+        cli.process();
+        std::string line = "get";
+        embeddedCliReceiveLine(cli.raw(), line.data(), line.size(), true);
+
+        REQUIRE(bindings.size() == 1);
+        auto displayed = cli.getDisplay();
+        REQUIRE(displayed.lines.size() == 2);
+        REQUIRE(displayed.lines[0] == "> get");
+        REQUIRE(displayed.lines[1] == ">");
+    }
+
+    SECTION("Too long line is rejected") {
+        std::string line(1000, 'a');
+        REQUIRE_FALSE(embeddedCliReceiveLine(cli.raw(), line.data(), line.size(), true));
+
+        REQUIRE(commands.empty());
+        REQUIRE(cli.getBytesSinceMark() == 0);
+    }
+}
@@ -0,0 +1,123 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+
+TEST_CASE("CLI. Scripts", "[cli]") {
+    CliWrapper cli = CliBuilder().execute(true).build();
+
+    auto &commands = cli.getReceivedCommands();
+    auto &bindings = cli.getCalledBindings();
+
+    cli.addBinding("get");
+    cli.addBinding("set");
+    embeddedCliAddBinding(cli.raw(), {
+            .name = "fail",
+            .help = nullptr,
+            .tokenizeArgs = false,
+            .context = nullptr,
+            .binding = [](EmbeddedCli *c, char *args, void *context) {
+                embeddedCliCommandFailed(c);
+            }
+    });
+    cli.process();
+
+    SECTION("Lines are executed in order") {
+        std::string script = "get led\r\n"
+                             "  # comment\n"
+                             "\n"
+                             "set led 1  \r"
+                             "get\n"
+                             "unknown 1";
+
+        auto result = embeddedCliRunScript(cli.raw(), script.c_str(), script.size(), nullptr);
+
+        REQUIRE(result.linesExecuted == 4);
+        REQUIRE(result.linesFailed == 0);
+        REQUIRE(result.firstFailedLine == 0);
+
+        REQUIRE(bindings.size() == 3);
+        REQUIRE(bindings[0].name == "get");
+        REQUIRE(bindings[0].args.size() == 1);
+        REQUIRE(bindings[0].args[0] == "led");
+        REQUIRE(bindings[1].name == "set");
+        REQUIRE(bindings[1].args.size() == 2);
+        REQUIRE(bindings[2].name == "get");
+        REQUIRE(bindings[2].args.empty());
+        REQUIRE(commands.size() == 1);
+        REQUIRE(commands[0].name == "unknown");
+
+        // script is not echoed and input line is not touched
+        REQUIRE(cli.getRawOutput() == "> ");
+    }
+
+    SECTION("Script ends at provided length") {
+        std::string script = "get\nset";
+
+        auto result = embeddedCliRunScript(cli.raw(), script.c_str(), 4, nullptr);
+
+        REQUIRE(result.linesExecuted == 1);
+        REQUIRE(bindings.size() == 1);
+    }
+
+    SECTION("Failed lines are reported") {
+        std::string script = "get\nfail\nset\nfail\n";
+        std::vector<std::pair<uint16_t, bool>> lines;
+
+        CliScriptOptions options = {
+                .flags = 0,
+                .onLineExecuted = [](EmbeddedCli *c, uint16_t line, bool success, void *context) {
+                    auto *l = (std::vector<std::pair<uint16_t, bool>> *) context;
+                    l->emplace_back(line, success);
+                },
+                .context = &lines
+        };
+        auto result = embeddedCliRunScript(cli.raw(), script.c_str(), script.size(), &options);
+
+        REQUIRE(result.linesExecuted == 4);
+        REQUIRE(result.linesFailed == 2);
+        REQUIRE(result.firstFailedLine == 2);
+        REQUIRE(lines.size() == 4);
+        REQUIRE(lines[0] == std::make_pair<uint16_t, bool>(1, true));
+        REQUIRE(lines[1] == std::make_pair<uint16_t, bool>(2, false));
+        REQUIRE(lines[3] == std::make_pair<uint16_t, bool>(4, false));
+    }
+
+    SECTION("Stop on error") {
+        std::string script = "get\nfail\nset\n";
+
+        CliScriptOptions options = {
+                .flags = CLI_SCRIPT_STOP_ON_ERROR,
+                .onLineExecuted = nullptr,
+                .context = nullptr
+        };
+        auto result = embeddedCliRunScript(cli.raw(), script.c_str(), script.size(), &options);
+
+        REQUIRE(result.linesExecuted == 2);
+        REQUIRE(result.firstFailedLine == 2);
+        REQUIRE(bindings.size() == 1);
+    }
+
+    SECTION("Too long line fails") {
+        std::string script = "get " + std::string(100, 'a');
+
+        auto result = embeddedCliRunScript(cli.raw(), script.c_str(), script.size(), nullptr);
+
+        REQUIRE(result.linesFailed == 1);
+        REQUIRE(bindings.empty());
+    }
+
+    SECTION("Execution time is measured") {
+        static uint32_t time = 0;
+        cli.raw()->getTime = [](EmbeddedCli *) {
+            time += 10;
+            return time;
+        };
+        std::string script = "get\n";
+
+        auto result = embeddedCliRunScript(cli.raw(), script.c_str(), script.size(), nullptr);
+
+        REQUIRE(result.time == 10);
+    }
+}
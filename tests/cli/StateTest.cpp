@@ -0,0 +1,129 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+
+static std::vector<uint8_t> saveState(CliWrapper &cli) {
+    std::vector<uint8_t> state(embeddedCliGetStateSize(cli.raw()));
+    REQUIRE(embeddedCliSaveState(cli.raw(), state.data(), state.size()) == state.size());
+    return state;
+}
+
+TEST_CASE("CLI. Save and restore state", "[cli][state]") {
+    CliWrapper cli = CliBuilder().build();
+    cli.addBinding("get");
+    cli.addBinding("set");
+    cli.process();
+
+    cli.sendLine("get a");
+    cli.sendLine("set b 1");
+    cli.send("get c");
+    cli.process();
+
+    auto state = saveState(cli);
+
+    SECTION("State contains only live data") {
+        // header, "get c", "set b 1\0get a\0" and checksum
+        REQUIRE(state.size() == 12 + 5 + 14 + 2);
+    }
+
+    SECTION("Current command and history are restored to other cli") {
+        CliWrapper restored = CliBuilder().staticAllocation().build();
+        restored.addBinding("get");
+        restored.addBinding("set");
+        REQUIRE(embeddedCliRestoreState(restored.raw(), state.data(), state.size()));
+
+        // invitation was already printed before sleep
+        restored.process();
+        REQUIRE(restored.getRawOutput().empty());
+
+        restored.sendLine(" d");
+        restored.process();
+        REQUIRE(restored.getCalledBindings().size() == 1);
+        REQUIRE(restored.getCalledBindings().back().name == "get");
+        REQUIRE(restored.getCalledBindings().back().args == std::vector<std::string>{"c", "d"});
+
+        restored.send("\x1B[A\x1B[A");
+        restored.process();
+        REQUIRE(restored.getDisplay().lines.back() == "> set b 1");
+
+        restored.send("\x1B[A");
+        restored.process();
+        REQUIRE(restored.getDisplay().lines.back() == "> get a");
+    }
+
+    SECTION("Only recent history items are restored to smaller history") {
+        EmbeddedCliConfig config;
+        embeddedCliInitDefaultConfig(&config);
+        config.historyBufferSize = 10;
+        EmbeddedCli *small = embeddedCliNew(&config);
+        REQUIRE(embeddedCliRestoreState(small, state.data(), state.size()));
+
+        std::vector<uint8_t> smallState(embeddedCliGetStateSize(small));
+        REQUIRE(embeddedCliSaveState(small, smallState.data(), smallState.size()) == smallState.size());
+        REQUIRE(smallState.size() == 12 + 5 + 8 + 2);
+        embeddedCliFree(small);
+    }
+
+    SECTION("Save fails if buffer is too small") {
+        std::vector<uint8_t> buffer(state.size() - 1);
+        REQUIRE(embeddedCliSaveState(cli.raw(), buffer.data(), buffer.size()) == 0);
+    }
+
+    SECTION("Corrupted state is not restored") {
+        CliWrapper restored = CliBuilder().build();
+        restored.process();
+
+        state[14] ^= 0x01;
+        REQUIRE_FALSE(embeddedCliRestoreState(restored.raw(), state.data(), state.size()));
+        REQUIRE_FALSE(embeddedCliRestoreState(restored.raw(), state.data(), 5));
+
+        restored.send("x");
+        restored.process();
+        REQUIRE(restored.getDisplay().lines.back() == "> x");
+    }
+
+    SECTION("History items that don't fit are not restored") {
+        EmbeddedCliConfig config;
+        embeddedCliInitDefaultConfig(&config);
+        config.cmdBufferSize = 128;
+        config.historyBufferSize = 256;
+        config.rxBufferSize = 128;
+        CliWrapper large(embeddedCliNew(&config), std::nullopt);
+        large.addBinding("get");
+        large.process();
+        large.sendLine("get " + std::string(100, 'a'));
+        large.sendLine("get b");
+        large.process();
+        auto largeState = saveState(large);
+
+        config.cmdBufferSize = 16;
+        CliWrapper small(embeddedCliNew(&config), std::nullopt);
+        small.addBinding("get");
+        REQUIRE(embeddedCliRestoreState(small.raw(), largeState.data(), largeState.size()));
+
+        small.send("\x1B[A");
+        small.process();
+        REQUIRE(small.getDisplay().lines.back() == "> get b");
+        small.send("\x1B[A");
+        small.process();
+        REQUIRE(small.getDisplay().lines.back() == "> get b");
+
+        // command must leave two chars for tokenization, same as typed one
+        large.send("get 1234567890");
+        large.process();
+        largeState = saveState(large);
+        REQUIRE_FALSE(embeddedCliRestoreState(small.raw(), largeState.data(), largeState.size()));
+    }
+
+    SECTION("Command that doesn't fit is not restored") {
+        EmbeddedCliConfig config;
+        embeddedCliInitDefaultConfig(&config);
+        config.cmdBufferSize = 4;
+        EmbeddedCli *small = embeddedCliNew(&config);
+        REQUIRE_FALSE(embeddedCliRestoreState(small, state.data(), state.size()));
+        embeddedCliFree(small);
+    }
+}
@@ -34,3 +34,16 @@ TEST_CASE("CLI. Static allocation", "[cli]") {
         REQUIRE(commands.back().args[0] == "led");
     }
 }
+
+TEST_CASE("CLI. Config that doesn't fit into 16 bit size", "[cli]") {
+    EmbeddedCliConfig config;
+    embeddedCliInitDefaultConfig(&config);
+    config.cmdBufferSize = 2048;
+    config.maxWatchCount = 32;
+
+    REQUIRE(embeddedCliRequiredSize(&config) == 0);
+    REQUIRE(embeddedCliNew(&config) == nullptr);
+
+    config.maxWatchCount = 2;
+    REQUIRE(embeddedCliRequiredSize(&config) > 3 * 2048);
+}
@@ -0,0 +1,117 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+
+static uint32_t currentTime = 0;
+
+TEST_CASE("CLI. Binding stats", "[cli]") {
+    CliWrapper cli = CliBuilder()
+            .bindingStats(true)
+            .build();
+
+    currentTime = 0;
+    cli.raw()->getTime = [](EmbeddedCli *) {
+        return currentTime;
+    };
+
+    // each call takes "duration" units of time and fails if args are not empty
+    uint32_t duration = 0;
+    embeddedCliAddBinding(cli.raw(), {
+            .name = "run",
+            .help = nullptr,
+            .tokenizeArgs = false,
+            .context = &duration,
+            .binding = [](EmbeddedCli *c, char *args, void *context) {
+                currentTime += *(uint32_t *) context;
+                if (args != nullptr)
+                    embeddedCliCommandFailed(c);
+            }
+    });
+
+    SECTION("Calls and errors are counted") {
+        cli.sendLine("run");
+        cli.sendLine("run");
+        cli.sendLine("run fail");
+        cli.process();
+
+        CliBindingStats stats;
+        REQUIRE(embeddedCliGetBindingStats(cli.raw(), "run", &stats));
+        REQUIRE(stats.calls == 3);
+        REQUIRE(stats.errors == 1);
+        REQUIRE(stats.latency[0] == 3);
+    }
+
+    SECTION("Latency histogram") {
+        for (uint32_t d: {0u, 1u, 2u, 3u, 4u, 1000u, 100000u}) {
+            duration = d;
+            cli.sendLine("run");
+            cli.process();
+        }
+
+        CliBindingStats stats;
+        REQUIRE(embeddedCliGetBindingStats(cli.raw(), "run", &stats));
+        REQUIRE(stats.calls == 7);
+        REQUIRE(stats.latency[0] == 1);
+        REQUIRE(stats.latency[1] == 1);
+        REQUIRE(stats.latency[2] == 2);
+        REQUIRE(stats.latency[3] == 1);
+        REQUIRE(stats.latency[10] == 1);
+        REQUIRE(stats.latency[CLI_LATENCY_BUCKETS - 1] == 1);
+    }
+
+    SECTION("Stats are reset") {
+        cli.sendLine("run");
+        cli.process();
+        embeddedCliResetBindingStats(cli.raw());
+
+        CliBindingStats stats;
+        REQUIRE(embeddedCliGetBindingStats(cli.raw(), "run", &stats));
+        REQUIRE(stats.calls == 0);
+        REQUIRE(stats.latency[0] == 0);
+    }
+
+    SECTION("Stats command") {
+        duration = 5;
+        cli.sendLine("run");
+        cli.sendLine("run x");
+        cli.sendLine("stats run");
+        cli.process();
+
+        auto lines = cli.getDisplay().lines;
+
+        REQUIRE(lines.size() == 6);
+        REQUIRE(lines[3] == " * run: 2 calls, 1 error");
+        REQUIRE(lines[4] == "\t<8:2");
+    }
+
+    SECTION("Stats command without errors") {
+        cli.sendLine("run");
+        cli.sendLine("stats run");
+        cli.process();
+
+        auto lines = cli.getDisplay().lines;
+
+        REQUIRE(lines[2] == " * run: 1 call, 0 errors");
+    }
+
+    SECTION("Stats for unknown command") {
+        CliBindingStats stats;
+    REQUIRE_FALSE(embeddedCliGetBindingStats(cli.raw(), "get", &stats));
+    }
+}
+
+TEST_CASE("CLI. Binding stats disabled", "[cli]") {
+    CliWrapper cli = CliBuilder().build();
+    cli.addBinding("get");
+
+    CliBindingStats stats;
+    REQUIRE_FALSE(embeddedCliGetBindingStats(cli.raw(), "get", &stats));
+
+    cli.sendLine("stats");
+    cli.process();
+
+    REQUIRE(cli.getReceivedCommands().size() == 1);
+    REQUIRE(cli.getReceivedCommands().back().name == "stats");
+}
@@ -0,0 +1,104 @@
+#include "embedded_cli.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+    struct TelnetContext {
+        std::string output;
+        std::vector<std::string> commands;
+    };
+
+    const char IAC = (char) 0xFF;
+    const char DONT = (char) 0xFE;
+    const char DO = (char) 0xFD;
+    const char WONT = (char) 0xFC;
+    const char WILL = (char) 0xFB;
+    const char SB = (char) 0xFA;
+    const char SE = (char) 0xF0;
+    const char ECHO = 1;
+    const char SGA = 3;
+    const char NAWS = 31;
+
+    std::string cmd(char command, char option) {
+        return {IAC, command, option};
+    }
+
+    void send(EmbeddedCli *cli, const std::string &bytes) {
+        embeddedCliTelnetReceive(cli, bytes.data(), bytes.size());
+        embeddedCliProcess(cli);
+    }
+}
+
+TEST_CASE("CLI. Telnet", "[cli]") {
+    EmbeddedCli *cli = embeddedCliNewDefault();
+    REQUIRE(cli != nullptr);
+
+    TelnetContext context;
+    cli->appContext = &context;
+    cli->writeChar = [](EmbeddedCli *c, char ch) {
+        ((TelnetContext *) c->appContext)->output += ch;
+    };
+    cli->onCommand = [](EmbeddedCli *c, CliCommand *command) {
+        auto *ctx = (TelnetContext *) c->appContext;
+        ctx->commands.push_back(command->args != nullptr ? command->args : command->name);
+    };
+
+    embeddedCliTelnetStart(cli);
+    REQUIRE(context.output == cmd(WILL, ECHO) + cmd(WILL, SGA) + cmd(DO, NAWS));
+    REQUIRE(embeddedCliGetWindowWidth(cli) == 0);
+    embeddedCliProcess(cli);
+    context.output.clear();
+
+    SECTION("Typical client negotiation") {
+        std::string naws = cmd(SB, NAWS) + std::string{0, 120, 0, 40} + std::string{IAC, SE};
+        send(cli, cmd(DO, ECHO) + cmd(DO, SGA) + cmd(WILL, SGA) + cmd(WILL, NAWS) + naws + "get\r" +
+                  std::string(1, '\0'));
+
+        // only client SGA was not requested yet
+        REQUIRE(context.output.substr(0, 3) == cmd(DO, SGA));
+        REQUIRE(context.output.find(IAC, 3) == std::string::npos);
+        REQUIRE(context.output.find("get\r\n> ") != std::string::npos);
+        REQUIRE(context.commands == std::vector<std::string>{"get"});
+        REQUIRE(embeddedCliGetWindowWidth(cli) == 120);
+    }
+
+    SECTION("Unknown options are refused") {
+        send(cli, cmd(DO, 24) + cmd(WILL, 24) + cmd(DONT, 24) + cmd(WONT, 24));
+
+        REQUIRE(context.output == cmd(WONT, 24) + cmd(DONT, 24));
+    }
+
+    SECTION("Disabled options are confirmed once") {
+        send(cli, cmd(DONT, ECHO) + cmd(DONT, ECHO) + cmd(WONT, NAWS));
+
+        REQUIRE(context.output == cmd(WONT, ECHO) + cmd(DONT, NAWS));
+    }
+
+    SECTION("Escaped IAC in data and subnegotiation") {
+        std::string naws = cmd(SB, NAWS) + std::string{1, IAC, IAC, 0, 40} + std::string{IAC, SE};
+        send(cli, naws + "a" + std::string{IAC, IAC} + "b\r\n");
+
+        REQUIRE(embeddedCliGetWindowWidth(cli) == 0x1FF);
+        // escaped byte is passed to cli (which ignores it), next byte is data
+        REQUIRE(context.commands == std::vector<std::string>{"ab"});
+    }
+
+    SECTION("Other commands are skipped") {
+        // NOP, AYT and unknown subnegotiation
+        send(cli, std::string{IAC, (char) 0xF1, IAC, (char) 0xF6} + cmd(SB, 24) + "xyz" +
+                  std::string{IAC, SE} + "set\r\n");
+
+        REQUIRE(context.commands == std::vector<std::string>{"set"});
+        REQUIRE(embeddedCliGetWindowWidth(cli) == 0);
+    }
+
+    SECTION("IAC in output is escaped") {
+        embeddedCliPrint(cli, "\xFF");
+        REQUIRE(context.output.find(std::string{IAC, IAC}) != std::string::npos);
+    }
+
+    embeddedCliFree(cli);
+}
@@ -0,0 +1,340 @@
+#include "CliWrapper.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+static std::mutex cliMutex;
+
+TEST_CASE("CLI. Usage from multiple threads", "[cli]") {
+    const int threadCount = 4;
+    const int bindingsPerThread = 4;
+    const int printsPerThread = 50;
+
+    EmbeddedCliConfig *config = embeddedCliDefaultConfig();
+    config->maxBindingCount = threadCount * bindingsPerThread;
+    config->lock = [](EmbeddedCli *) {
+        cliMutex.lock();
+    };
+    config->unlock = [](EmbeddedCli *) {
+        cliMutex.unlock();
+    };
+    CliWrapper cli(embeddedCliNew(config), std::nullopt);
+
+    // each binding prints its name, so output from binding and from other
+    // threads is mixed
+    std::vector<std::string> names;
+    for (int t = 0; t < threadCount; ++t) {
+        for (int b = 0; b < bindingsPerThread; ++b) {
+            names.push_back("cmd-" + std::to_string(t) + "-" + std::to_string(b));
+        }
+    }
+    std::atomic<int> calls{0};
+
+    std::atomic<int> finished{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int b = 0; b < bindingsPerThread; ++b) {
+                embeddedCliAddBinding(cli.raw(), {
+                        .name = names[t * bindingsPerThread + b].c_str(),
+                        .help = nullptr,
+                        .tokenizeArgs = false,
+                        .context = &calls,
+                        .binding = [](EmbeddedCli *c, char *, void *context) {
+                            ++*(std::atomic<int> *) context;
+                            embeddedCliPrint(c, "from binding");
+                        }
+                });
+            }
+            for (int i = 0; i < printsPerThread; ++i) {
+                embeddedCliPrint(cli.raw(), ("thread " + std::to_string(t)).c_str());
+            }
+            ++finished;
+        });
+    }
+
+    // commands are received and processed while other threads work
+    size_t sent = 0;
+    while (finished < threadCount) {
+        cli.sendLine(names[sent % names.size()]);
+        ++sent;
+        cli.process();
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    // all bindings are added now, so each of them must be found
+    calls = 0;
+    for (const auto &name: names) {
+        cli.sendLine(name + " ");
+        cli.process();
+    }
+    REQUIRE(calls == (int) names.size());
+
+    size_t printed = 0;
+    for (const auto &line: cli.getDisplay().lines) {
+        if (line.rfind("thread ", 0) == 0)
+            ++printed;
+    }
+    REQUIRE(printed == threadCount * printsPerThread);
+}
+
+TEST_CASE("CLI. Usage from other thread while binding is executed", "[cli]") {
+    EmbeddedCliConfig *config = embeddedCliDefaultConfig();
+    config->enableExecute = true;
+    config->lock = [](EmbeddedCli *) {
+        cliMutex.lock();
+    };
+    config->unlock = [](EmbeddedCli *) {
+        cliMutex.unlock();
+    };
+    CliWrapper cli(embeddedCliNew(config), std::nullopt);
+
+    static std::atomic<bool> started;
+    static std::atomic<bool> done;
+    static std::atomic<int> otherCalls;
+    started = false;
+    done = false;
+    otherCalls = 0;
+
+    // binding prints only after other thread tried to use cli
+    embeddedCliAddBinding(cli.raw(), {
+            .name = "a",
+            .help = nullptr,
+            .tokenizeArgs = false,
+            .context = nullptr,
+            .binding = [](EmbeddedCli *c, char *, void *) {
+                started = true;
+                while (!done)
+                    std::this_thread::yield();
+                embeddedCliPrint(c, "A-OUTPUT");
+            }
+    });
+    embeddedCliAddBinding(cli.raw(), {
+            .name = "b",
+            .help = nullptr,
+            .tokenizeArgs = false,
+            .context = nullptr,
+            .binding = [](EmbeddedCli *c, char *, void *) {
+                ++otherCalls;
+                embeddedCliPrint(c, "B-OUTPUT");
+            }
+    });
+
+    bool executed = true;
+    bool processed = false;
+    std::thread other([&]() {
+        while (!started)
+            std::this_thread::yield();
+        executed = embeddedCliExecute(cli.raw(), "b", 0);
+        embeddedCliPrint(cli.raw(), "B-PRINT");
+        // typed command is left in rx buffer until binding finishes
+        for (char c: std::string("b\n"))
+            embeddedCliReceiveChar(cli.raw(), c);
+        processed = embeddedCliProcess(cli.raw());
+        done = true;
+    });
+
+    cli.sendLine("a");
+    cli.process();
+    other.join();
+
+    REQUIRE_FALSE(executed);
+    REQUIRE_FALSE(processed);
+    // typed command is executed after first one finishes
+    cli.process();
+    REQUIRE(otherCalls == 1);
+
+    auto lines = cli.getDisplay().lines;
+    REQUIRE(lines.size() == 6);
+    REQUIRE(lines[0] == "> a");
+    REQUIRE(lines[1] == "B-PRINT");
+    REQUIRE(lines[2] == "A-OUTPUT");
+    REQUIRE(lines[3] == "> b");
+    REQUIRE(lines[4] == "B-OUTPUT");
+    REQUIRE(lines[5] == ">");
+
+    // cli is usable from other threads again
+    REQUIRE(embeddedCliExecute(cli.raw(), "b", 0));
+    REQUIRE(otherCalls == 2);
+}
+
+TEST_CASE("CLI. Input left while command is executed is reported when it finishes", "[cli]") {
+    EmbeddedCliConfig *config = embeddedCliDefaultConfig();
+    config->enableExecute = true;
+    config->lock = [](EmbeddedCli *) {
+        cliMutex.lock();
+    };
+    config->unlock = [](EmbeddedCli *) {
+        cliMutex.unlock();
+    };
+    CliWrapper cli(embeddedCliNew(config), std::nullopt);
+
+    static std::atomic<bool> started;
+    static std::atomic<bool> done;
+    static std::atomic<int> readyCount;
+    started = false;
+    done = false;
+    readyCount = 0;
+    cli.raw()->onInputReady = [](EmbeddedCli *) {
+        ++readyCount;
+    };
+
+    embeddedCliAddBinding(cli.raw(), {
+            .name = "a",
+            .help = nullptr,
+            .tokenizeArgs = false,
+            .context = nullptr,
+            .binding = [](EmbeddedCli *, char *, void *) {
+                started = true;
+                while (!done)
+                    std::this_thread::yield();
+            }
+    });
+    cli.process();
+
+    bool processed = true;
+    std::thread other([&]() {
+        while (!started)
+            std::this_thread::yield();
+        embeddedCliReceiveChar(cli.raw(), 'x');
+        // only notification after command is counted
+        readyCount = 0;
+        processed = embeddedCliProcess(cli.raw());
+        done = true;
+    });
+    REQUIRE(embeddedCliExecute(cli.raw(), "a", 0));
+    other.join();
+
+    // process doesn't spin while command is executed
+    REQUIRE_FALSE(processed);
+    REQUIRE(readyCount == 1);
+
+    cli.process();
+    REQUIRE(cli.getDisplay().lines.back() == "> x");
+
+    // nothing is reported when input wasn't left
+    REQUIRE(embeddedCliExecute(cli.raw(), "a", 0));
+    REQUIRE(readyCount == 1);
+}
+
+TEST_CASE("CLI. Output from other thread is not redirected with command output", "[cli]") {
+    EmbeddedCliConfig *config = embeddedCliDefaultConfig();
+    config->enableExecute = true;
+    config->lock = [](EmbeddedCli *) {
+        cliMutex.lock();
+    };
+    config->unlock = [](EmbeddedCli *) {
+        cliMutex.unlock();
+    };
+    config->filterBufferSize = 32;
+    CliWrapper cli(embeddedCliNew(config), std::nullopt);
+
+    static std::atomic<bool> started;
+    static std::atomic<bool> done;
+
+    // binding prints only after other thread printed its message
+    embeddedCliAddBinding(cli.raw(), {
+            .name = "a",
+            .help = nullptr,
+            .tokenizeArgs = false,
+            .context = nullptr,
+            .binding = [](EmbeddedCli *c, char *, void *) {
+                started = true;
+                while (!done)
+                    std::this_thread::yield();
+                embeddedCliPrint(c, "A-OUTPUT");
+                embeddedCliPrint(c, "A-HIDDEN");
+            }
+    });
+    cli.process();
+
+    auto runWithPrint = [&](const std::function<void()> &execute) {
+        started = false;
+        done = false;
+        std::thread other([&]() {
+            while (!started)
+                std::this_thread::yield();
+            embeddedCliPrint(cli.raw(), "OTHER");
+            done = true;
+        });
+        execute();
+        other.join();
+    };
+
+    SECTION("Discarded output") {
+        runWithPrint([&]() {
+            REQUIRE(embeddedCliExecute(cli.raw(), "a", 0));
+        });
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines.size() == 2);
+        REQUIRE(lines[0] == "OTHER");
+        REQUIRE(lines[1] == ">");
+    }
+
+    SECTION("Filtered output") {
+        runWithPrint([&]() {
+            cli.sendLine("a | grep OUT");
+            cli.process();
+        });
+
+        auto lines = cli.getDisplay().lines;
+        REQUIRE(lines.size() == 4);
+        REQUIRE(lines[0] == "> a | grep OUT");
+        REQUIRE(lines[1] == "OTHER");
+        REQUIRE(lines[2] == "A-OUTPUT");
+        REQUIRE(lines[3] == ">");
+    }
+}
+
+TEST_CASE("CLI. Parallel creation", "[cli]") {
+    const int threadCount = 8;
+
+    // single config is shared by all threads, it must not be modified
+    EmbeddedCliConfig shared;
+    embeddedCliInitDefaultConfig(&shared);
+    shared.maxBindingCount = 4;
+
+    std::vector<EmbeddedCli *> created(threadCount * 2, nullptr);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            created[t * 2] = embeddedCliNew(&shared);
+
+            // each thread also creates cli from its own config
+            EmbeddedCliConfig config;
+            embeddedCliInitDefaultConfig(&config);
+            config.invitation = "$ ";
+            created[t * 2 + 1] = embeddedCliNew(&config);
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    REQUIRE(shared.cliBuffer == nullptr);
+    REQUIRE(shared.cliBufferSize == 0);
+    for (size_t i = 0; i < created.size(); ++i) {
+        REQUIRE(created[i] != nullptr);
+        for (size_t j = 0; j < i; ++j) {
+            REQUIRE(created[i] != created[j]);
+        }
+    }
+
+    for (auto *c: created) {
+        CliWrapper cli(c, std::nullopt);
+        cli.addBinding("get");
+        cli.sendLine("get 1");
+        cli.process();
+        REQUIRE(cli.getCalledBindings().size() == 1);
+    }
+}
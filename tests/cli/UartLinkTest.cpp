@@ -0,0 +1,100 @@
+#include "UartLink.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+
+static const std::vector<std::string> session = {
+        "get led",
+        "set led 1",
+        "help",
+        "get adc 2",
+        "set pwm 3 50",
+};
+
+static void addBindings(UartLink &link) {
+    for (const char *name: {"get", "set"}) {
+        embeddedCliAddBinding(link.raw(), {
+                .name = name,
+                .help = "Command with some help",
+                .tokenizeArgs = true,
+                .context = nullptr,
+                .binding = [](EmbeddedCli *cli, char *, void *) {
+                    embeddedCliPrint(cli, "ok");
+                }
+        });
+    }
+}
+
+static UartLink::Report runSession(uint32_t baudRate, uint32_t processPeriodUs, uint32_t keyIntervalUs,
+                                   size_t txFifoSize = 16) {
+    EmbeddedCliConfig config;
+    embeddedCliInitDefaultConfig(&config);
+    config.enableAutoComplete = false;
+
+    UartLink::Config linkConfig;
+    linkConfig.baudRate = baudRate;
+    linkConfig.processPeriodUs = processPeriodUs;
+    linkConfig.keyIntervalUs = keyIntervalUs;
+    linkConfig.txFifoSize = txFifoSize;
+
+    UartLink link(&config, linkConfig);
+    addBindings(link);
+    return link.runSession(session);
+}
+
+TEST_CASE("CLI. UART link", "[cli][uart]") {
+    SECTION("Echo of typed key takes at least two byte times") {
+        // 1042us per byte
+        auto report = runSession(9600, 1000, 100000);
+
+        REQUIRE(report.commands == session.size());
+        REQUIRE(report.latenciesUs.size() == report.rxBytes - session.size());
+        REQUIRE(report.latencyPercentile(1) >= 2 * 1041);
+        // key is processed at most one period after it arrives
+        REQUIRE(report.latencyPercentile(50) <= 2 * 1042 + 1000);
+    }
+
+    SECTION("Latency is limited by process period at high baud rate") {
+        auto fast = runSession(921600, 5000, 100000);
+        auto slow = runSession(921600, 100, 100000);
+
+        REQUIRE(fast.latencyPercentile(50) > slow.latencyPercentile(50));
+        REQUIRE(fast.latencyPercentile(100) <= 5000 + 2 * 11 + 1);
+        REQUIRE(slow.latencyPercentile(100) <= 100 + 2 * 11 + 1);
+    }
+
+    SECTION("Throughput of pasted commands grows with baud rate") {
+        auto slow = runSession(9600, 1000, 0);
+        auto fast = runSession(115200, 1000, 0);
+
+        REQUIRE(slow.txBytes == fast.txBytes);
+        REQUIRE(fast.commandsPerSecond() > slow.commandsPerSecond());
+        // link can't be faster than its baud rate
+        REQUIRE(slow.durationUs >= (slow.rxBytes + slow.txBytes) * 1041 / 2);
+    }
+
+    SECTION("Small TX FIFO doesn't change output") {
+        auto small = runSession(9600, 1000, 0, 1);
+        auto large = runSession(9600, 1000, 0, 256);
+
+        REQUIRE(small.txBytes == large.txBytes);
+        REQUIRE(small.latencyPercentile(100) >= large.latencyPercentile(100));
+    }
+}
+
+TEST_CASE("CLI. UART link report", "[.][bench][uart]") {
+    std::printf("%8s %8s %10s %10s %10s %10s %10s\n",
+                "baud", "period", "p50 us", "p90 us", "p99 us", "max us", "cmd/s");
+    for (uint32_t baud: {9600u, 19200u, 38400u, 57600u, 115200u, 230400u, 460800u, 921600u}) {
+        for (uint32_t period: {100u, 1000u, 10000u}) {
+            auto report = runSession(baud, period, 0);
+            std::printf("%8u %8u %10llu %10llu %10llu %10llu %10.1f\n", baud, period,
+                        (unsigned long long) report.latencyPercentile(50),
+                        (unsigned long long) report.latencyPercentile(90),
+                        (unsigned long long) report.latencyPercentile(99),
+                        (unsigned long long) report.latencyPercentile(100),
+                        report.commandsPerSecond());
+        }
+    }
+}
@@ -0,0 +1,206 @@
+#include "CliWrapper.h"
+#include "CliBuilder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+
+static uint32_t currentTime = 0;
+
+TEST_CASE("CLI. Watch", "[cli]") {
+    CliWrapper cli = CliBuilder()
+            .watches(2)
+            .execute(true)
+            .filterBuffer(32)
+            .build();
+
+    currentTime = 0;
+    cli.raw()->getTime = [](EmbeddedCli *) {
+        return currentTime;
+    };
+
+    auto &bindings = cli.getCalledBindings();
+    cli.addBinding("get");
+    cli.addBinding("raw", std::nullopt, false);
+
+    // prints given amount of lines with counter
+    uint32_t lines = 1;
+    embeddedCliAddBinding(cli.raw(), {
+            .name = "lines",
+            .help = nullptr,
+            .tokenizeArgs = false,
+            .context = &lines,
+            .binding = [](EmbeddedCli *c, char *args, void *context) {
+                for (uint32_t i = 0; i < *(uint32_t *) context; ++i) {
+                    embeddedCliPrint(c, "line");
+                }
+            }
+    });
+    cli.process();
+
+    SECTION("Command is executed periodically") {
+        cli.sendLine("watch 100 get a \"b c\"");
+        cli.process();
+
+        REQUIRE(bindings.size() == 1);
+        REQUIRE(bindings[0].args.size() == 2);
+        REQUIRE(bindings[0].args[0] == "a");
+        REQUIRE(bindings[0].args[1] == "b c");
+
+        currentTime = 99;
+        cli.process();
+        REQUIRE(bindings.size() == 1);
+
+        currentTime = 100;
+        cli.process();
+        REQUIRE(bindings.size() == 2);
+        REQUIRE(bindings[1].args.size() == 2);
+        REQUIRE(bindings[1].args[1] == "b c");
+
+        // missed executions are skipped
+        currentTime = 1000;
+        cli.process();
+        currentTime = 1050;
+        cli.process();
+        REQUIRE(bindings.size() == 3);
+        currentTime = 1100;
+        cli.process();
+        REQUIRE(bindings.size() == 4);
+    }
+
+    SECTION("Args of not tokenized command are kept as typed") {
+        cli.sendLine("watch  10   raw x  \"a  b\"");
+        cli.process();
+        currentTime = 10;
+        cli.process();
+        cli.send("q");
+        cli.sendLine("raw x  \"a  b\"");
+        cli.process();
+
+        REQUIRE(bindings.size() == 3);
+        REQUIRE(bindings[1].args.size() == 1);
+        REQUIRE(bindings[1].args[0] == "x  \"a  b\"");
+        REQUIRE(bindings[2].args == bindings[1].args);
+    }
+
+    SECTION("Any key cancels watch") {
+        cli.sendLine("watch 10 get");
+        cli.process();
+        REQUIRE(bindings.size() == 1);
+
+        cli.send("g");
+        cli.process();
+
+        currentTime = 100;
+        cli.process();
+        REQUIRE(bindings.size() == 1);
+
+        auto display = cli.getDisplay();
+        REQUIRE(display.lines.back() == ">");
+
+        cli.sendLine("get");
+        cli.process();
+        REQUIRE(bindings.size() == 2);
+    }
+
+    SECTION("Output is redrawn in place") {
+        lines = 2;
+        cli.sendLine("watch 10 lines");
+        cli.process();
+        size_t mark = cli.getRawOutput().size();
+
+        currentTime = 10;
+        cli.process();
+        std::string output = cli.getRawOutput().substr(mark);
+        REQUIRE(output == "\x1B[2Aline\x1B[K\r\nline\x1B[K\r\n");
+    }
+
+    SECTION("Multiple watches") {
+        cli.sendLine("watch 10 lines");
+        cli.process();
+        cli.send("\x1B");
+        cli.process();
+        REQUIRE(embeddedCliExecute(cli.raw(), "watch 10 lines", 0));
+        REQUIRE(embeddedCliExecute(cli.raw(), "watch 30 get", 0));
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "watch 30 get", 0));
+        cli.process();
+        REQUIRE(bindings.size() == 1);
+
+        size_t mark = cli.getRawOutput().size();
+        currentTime = 10;
+        cli.process();
+        // first watch is moved above output of second watch and then back
+        std::string output = cli.getRawOutput().substr(mark);
+        REQUIRE(output == "\x1B[1Aline\x1B[K\r\n");
+        REQUIRE(bindings.size() == 1);
+
+        currentTime = 30;
+        cli.process();
+        REQUIRE(bindings.size() == 2);
+    }
+
+    SECTION("Changed number of lines clears output below") {
+        REQUIRE(embeddedCliExecute(cli.raw(), "watch 10 lines", 0));
+        REQUIRE(embeddedCliExecute(cli.raw(), "watch 10 lines", 0));
+        cli.process();
+
+        lines = 2;
+        size_t mark = cli.getRawOutput().size();
+        currentTime = 10;
+        cli.process();
+        std::string output = cli.getRawOutput().substr(mark);
+        REQUIRE(output == "\x1B[2Aline\x1B[K\r\nline\x1B[K\r\n\x1B[J"
+                          "line\x1B[K\r\nline\x1B[K\r\n\x1B[J");
+    }
+
+    SECTION("Removing watched binding cancels watch") {
+        cli.sendLine("watch 10 get");
+        cli.process();
+
+        embeddedCliRemoveBinding(cli.raw(), "get");
+        cli.process();
+        REQUIRE(cli.getDisplay().lines.back() == ">");
+
+        cli.addBinding("get");
+        currentTime = 10;
+        cli.process();
+        REQUIRE(bindings.size() == 1);
+    }
+
+    SECTION("Invalid arguments") {
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "watch", 0));
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "watch 10", 0));
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "watch 0 get", 0));
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "watch 1x get", 0));
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "watch 99999999999 get", 0));
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "watch 10 unknown", 0));
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "watch 10 watch 10 get", 0));
+
+        cli.process();
+        REQUIRE(bindings.empty());
+    }
+
+    SECTION("Output of watched command can't be filtered") {
+        cli.sendLine("watch 100 get | grep beta");
+        cli.process();
+        REQUIRE(cli.getDisplay().lines[1] == "Output of watched command can't be filtered");
+
+        currentTime = 100;
+        cli.process();
+        REQUIRE(bindings.empty());
+    }
+
+    SECTION("Watch requires time") {
+        cli.raw()->getTime = nullptr;
+        REQUIRE_FALSE(embeddedCliExecute(cli.raw(), "watch 10 get", 0));
+    }
+}
+
+TEST_CASE("CLI. Watch is not available by default", "[cli]") {
+    CliWrapper cli = CliBuilder().build();
+
+    cli.sendLine("watch 10 get");
+    cli.process();
+
+    REQUIRE(cli.getReceivedCommands().size() == 1);
+    REQUIRE(cli.getReceivedCommands()[0].name == "watch");
+}
@@ -0,0 +1,37 @@
+#include "fuzz/FuzzSession.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Worst inputs found by embedded_cli_fuzz are saved to tests/fuzz/worst as
+// "<budget>-<description>.bin", where budget is maximum number of bytes that
+// single embeddedCliProcess call can output for this input.
+
+TEST_CASE("CLI. Worst case inputs", "[cli][fuzz]") {
+    size_t inputsCount = 0;
+
+    for (const auto &entry: std::filesystem::directory_iterator(CLI_WORST_CASE_DIR)) {
+        if (entry.path().extension() != ".bin")
+            continue;
+        ++inputsCount;
+
+        std::string name = entry.path().filename().string();
+        size_t budget = std::stoul(name.substr(0, name.find('-')));
+
+        std::ifstream file(entry.path(), std::ios::binary);
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        FuzzCost cost = FuzzSession::run(input.data(), input.size());
+
+        INFO(name);
+        REQUIRE(cost.processCalls > 0);
+        REQUIRE(cost.maxOutputBytes <= budget);
+    }
+
+    REQUIRE(inputsCount > 0);
+}
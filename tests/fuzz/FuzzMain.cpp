@@ -0,0 +1,36 @@
+#include "FuzzSession.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+// Driver for builds without libFuzzer (for example, with afl-g++). Runs
+// every file from arguments (or stdin if there are none) and prints its cost.
+
+static void runInput(const char *name, const std::vector<uint8_t> &input) {
+    InstructionCounter counter;
+    FuzzCost cost = FuzzSession::run(input.data(), input.size(), &counter);
+    std::printf("%s: %zu process calls, max %zu bytes, max %llu instructions\n", name,
+                cost.processCalls, cost.maxOutputBytes, (unsigned long long) cost.maxInstructions);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        runInput("stdin", input);
+        return 0;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "Can't open %s\n", argv[i]);
+            return 1;
+        }
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        runInput(argv[i], input);
+    }
+    return 0;
+}
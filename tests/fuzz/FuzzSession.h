@@ -0,0 +1,191 @@
+#ifndef EMBEDDED_CLI_FUZZSESSION_H
+#define EMBEDDED_CLI_FUZZSESSION_H
+
+#include "embedded_cli.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef __linux__
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#endif
+
+/**
+ * Counts instructions executed in user space (Linux only). If counter is not
+ * available (other OS, no permissions or virtualized PMU), isAvailable
+ * returns false and cost is measured by output bytes only.
+ */
+class InstructionCounter {
+public:
+    InstructionCounter() {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    InstructionCounter(const InstructionCounter &) = delete;
+
+    InstructionCounter &operator=(const InstructionCounter &) = delete;
+
+    ~InstructionCounter() {
+#ifdef __linux__
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+
+    bool isAvailable() const {
+        return fd >= 0;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd < 0)
+            return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    /**
+     * @return number of instructions since start (0 if counter is not available)
+     */
+    uint64_t stop() {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (fd < 0)
+            return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != (ssize_t) sizeof(count))
+            count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd = -1;
+};
+
+/**
+ * Worst cost of single embeddedCliProcess call
+ */
+struct FuzzCost {
+    /**
+     * Maximum number of bytes written by cli during single call
+     */
+    size_t maxOutputBytes = 0;
+
+    /**
+     * Maximum number of instructions of single call (0 if not measured)
+     */
+    uint64_t maxInstructions = 0;
+
+    /**
+     * Number of embeddedCliProcess calls
+     */
+    size_t processCalls = 0;
+};
+
+/**
+ * Runs fuzzer input on a fresh cli and measures cost of each call to
+ * embeddedCliProcess. Same format is used by fuzz target and by regression
+ * test that replays saved worst inputs.
+ *
+ * First byte of input selects options:
+ * bit 0 - live autocompletion
+ * bit 1 - chaining
+ * bit 2 - output filters
+ * bits 4-5 - chars received between process calls (1, 4, 16 or 64)
+ * Other bytes are received by cli as is. Bindings:
+ * "get" - walks all tokens with embeddedCliGetToken and embeddedCliFindToken
+ * "print" - prints its args with embeddedCliPrint
+ * "set" - does nothing
+ */
+class FuzzSession {
+public:
+    static FuzzCost run(const uint8_t *data, size_t size, InstructionCounter *counter = nullptr) {
+        FuzzCost cost;
+        if (size == 0)
+            return cost;
+
+        uint8_t options = data[0];
+        ++data;
+        --size;
+
+        EmbeddedCliConfig config;
+        embeddedCliInitDefaultConfig(&config);
+        config.cmdBufferSize = 128;
+        config.historyBufferSize = 512;
+        config.enableAutoComplete = (options & 0x01u) != 0;
+        config.enableChaining = (options & 0x02u) != 0;
+        config.filterBufferSize = (options & 0x04u) != 0 ? 32 : 0;
+        size_t chunk = (size_t) 1 << (2 * ((options >> 4) & 0x03u));
+
+        FuzzSession session;
+        EmbeddedCli *cli = embeddedCliNew(&config);
+        if (cli == nullptr)
+            return cost;
+        cli->appContext = &session;
+        cli->writeChar = [](EmbeddedCli *c, char) {
+            ++((FuzzSession *) c->appContext)->outputBytes;
+        };
+        cli->onCommand = [](EmbeddedCli *, CliCommand *) {};
+        embeddedCliAddBinding(cli, {"get", "Get value", true, nullptr, onGet});
+        embeddedCliAddBinding(cli, {"print", "Print args", false, nullptr, onPrint});
+        embeddedCliAddBinding(cli, {"set", nullptr, true, nullptr, nullptr});
+
+        size_t pos = 0;
+        do {
+            for (size_t i = 0; i < chunk && pos < size; ++i, ++pos) {
+                embeddedCliReceiveChar(cli, (char) data[pos]);
+            }
+
+            session.outputBytes = 0;
+            if (counter != nullptr)
+                counter->start();
+            embeddedCliProcess(cli);
+            uint64_t instructions = counter != nullptr ? counter->stop() : 0;
+
+            ++cost.processCalls;
+            if (session.outputBytes > cost.maxOutputBytes)
+                cost.maxOutputBytes = session.outputBytes;
+            if (instructions > cost.maxInstructions)
+                cost.maxInstructions = instructions;
+        } while (pos < size);
+
+        embeddedCliFree(cli);
+        return cost;
+    }
+
+private:
+    size_t outputBytes = 0;
+
+    static void onGet(EmbeddedCli *, char *args, void *) {
+        uint16_t count = embeddedCliGetTokenCount(args);
+        for (uint16_t i = 1; i <= count; ++i) {
+            const char *token = embeddedCliGetToken(args, i);
+            if (token == nullptr || embeddedCliFindToken(args, token) == 0)
+                std::abort();
+        }
+    }
+
+    static void onPrint(EmbeddedCli *cli, char *args, void *) {
+        if (args != nullptr)
+            embeddedCliPrint(cli, args);
+    }
+};
+
+#endif //EMBEDDED_CLI_FUZZSESSION_H
@@ -0,0 +1,61 @@
+#include "FuzzSession.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Fuzzing objective is the worst cost of single embeddedCliProcess call
+// (instructions if they can be counted, output bytes otherwise). Cost is
+// reported to libFuzzer as extra counters (one per logarithmic bucket), so
+// inputs with new highest cost are kept in corpus like inputs with new
+// coverage. Each input that beats current maximum is saved to directory from
+// CLI_FUZZ_WORST_DIR (current directory by default) as
+// "<output bytes>-<cost>.bin", ready to be copied to tests/fuzz/worst.
+
+#define COST_BUCKETS 256
+
+#if defined(__clang__) && defined(__linux__)
+__attribute__((section("__libfuzzer_extra_counters")))
+#endif
+static uint8_t costCounters[COST_BUCKETS];
+
+static uint64_t worstCost = 0;
+
+/**
+ * Bucket is log2 of cost with 8 sub-steps per power of two
+ */
+static size_t getCostBucket(uint64_t cost) {
+    if (cost < 8)
+        return (size_t) cost;
+    int log = 63 - __builtin_clzll(cost);
+    size_t bucket = (size_t) log * 8 + (size_t) ((cost >> (log - 3)) & 0x07u);
+    return bucket < COST_BUCKETS ? bucket : COST_BUCKETS - 1;
+}
+
+static void saveWorst(const uint8_t *data, size_t size, const FuzzCost &cost, uint64_t objective) {
+    const char *dir = std::getenv("CLI_FUZZ_WORST_DIR");
+    std::string path = dir != nullptr ? dir : ".";
+    path += "/" + std::to_string(cost.maxOutputBytes) + "-" + std::to_string(objective) + ".bin";
+
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return;
+    std::fwrite(data, 1, size, file);
+    std::fclose(file);
+    std::fprintf(stderr, "New worst input: %s (%zu bytes, %llu instructions)\n", path.c_str(),
+                 cost.maxOutputBytes, (unsigned long long) cost.maxInstructions);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static InstructionCounter counter;
+
+    FuzzCost cost = FuzzSession::run(data, size, &counter);
+    uint64_t objective = counter.isAvailable() ? cost.maxInstructions : cost.maxOutputBytes;
+
+    costCounters[getCostBucket(objective)] = 1;
+    if (objective > worstCost) {
+        worstCost = objective;
+        saveWorst(data, size, cost, objective);
+    }
+    return 0;
+}